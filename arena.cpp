@@ -0,0 +1,66 @@
+#include "arena.h"
+#include <cstdlib>
+
+using namespace std;
+
+Arena::~Arena() {
+    runFinalizers();
+    for (char* b : blocks) free(b);
+    for (char* b : large) free(b);
+}
+
+void Arena::runFinalizers() {
+    // Orden inverso de construcción (los padres antes que sus hijos)
+    for (Finalizer* f = finalizers; f; f = f->next) {
+        f->destroy(f->object);
+    }
+    finalizers = nullptr;
+}
+
+void* Arena::allocateSlow(size_t size, size_t align) {
+    // Objetos enormes van a su propio bloque para no desperdiciar el actual
+    if (size + align > kBlockSize / 4) {
+        char* b = static_cast<char*>(malloc(size + align));
+        if (!b) throw bad_alloc();
+        large.push_back(b);
+        used += size;
+        size_t pad = (align - reinterpret_cast<size_t>(b) % align) % align;
+        return b + pad;
+    }
+
+    char* b = static_cast<char*>(malloc(kBlockSize));
+    if (!b) throw bad_alloc();
+    blocks.push_back(b);
+    cursor = b;
+    limit = b + kBlockSize;
+    return allocate(size, align);
+}
+
+void Arena::absorb(Arena& other) {
+    blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+    large.insert(large.end(), other.large.begin(), other.large.end());
+    // Los finalizers de other se encadenan delante de los propios
+    if (other.finalizers) {
+        Finalizer* tail = other.finalizers;
+        while (tail->next) tail = tail->next;
+        tail->next = finalizers;
+        finalizers = other.finalizers;
+    }
+    used += other.used;
+    other.blocks.clear();
+    other.large.clear();
+    other.cursor = other.limit = nullptr;
+    other.finalizers = nullptr;
+    other.used = 0;
+}
+
+void Arena::reset() {
+    runFinalizers();
+    for (char* b : large) free(b);
+    large.clear();
+    for (size_t i = 1; i < blocks.size(); i++) free(blocks[i]);
+    if (!blocks.empty()) blocks.resize(1);
+    cursor = blocks.empty() ? nullptr : blocks[0];
+    limit = blocks.empty() ? nullptr : blocks[0] + kBlockSize;
+    used = 0;
+}
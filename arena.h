@@ -0,0 +1,91 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// ===========================================================
+//  Arena de bloques para los nodos del AST.
+//  Cada nodo se reserva con un bump de puntero dentro del bloque
+//  actual; no hay delete individual. Al destruir (o reset) la
+//  arena se ejecutan los destructores pendientes en orden inverso
+//  y se liberan todos los bloques de una vez.
+// ===========================================================
+
+class Arena {
+private:
+    // Destructor pendiente, guardado justo antes del objeto en el bloque
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    static const size_t kBlockSize = 64 * 1024;
+
+    vector<char*> blocks;     // bloques de kBlockSize (el primero se conserva en reset)
+    vector<char*> large;      // reservas mayores que un bloque
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    Finalizer* finalizers = nullptr;
+    size_t used = 0;          // bytes entregados (estadística)
+
+    void* allocateSlow(size_t size, size_t align);
+    void runFinalizers();
+
+    template <typename T>
+    static void destroyAs(void* p) { static_cast<T*>(p)->~T(); }
+
+public:
+    Arena() {}
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Memoria cruda alineada; válida hasta reset()/destrucción
+    void* allocate(size_t size, size_t align) {
+        size_t pad = (align - reinterpret_cast<size_t>(cursor) % align) % align;
+        if (cursor && size + pad <= static_cast<size_t>(limit - cursor)) {
+            char* p = cursor + pad;
+            cursor = p + size;
+            used += size;
+            return p;
+        }
+        return allocateSlow(size, align);
+    }
+
+    // Construye un T en la arena. Si T necesita destructor (strings,
+    // listas, vectores) se encadena un Finalizer para el teardown.
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        if (is_trivially_destructible<T>::value) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+        Finalizer* f = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        f->destroy = &destroyAs<T>;
+        f->object = obj;
+        f->next = finalizers;
+        finalizers = f;
+        return obj;
+    }
+
+    // Destruye todos los objetos y vuelve al primer bloque
+    // (memoria constante en procesos que compilan muchas veces)
+    void reset();
+
+    // Adopta los bloques y objetos de other (la arena de otro hilo);
+    // other queda vacía y sus objetos viven hasta el teardown de ésta
+    void absorb(Arena& other);
+
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const { return blocks.size() * kBlockSize; }
+};
+
+#endif // ARENA_H
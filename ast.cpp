@@ -26,26 +26,106 @@ string Exp::binopToChar(BinaryOp op) {
     }
 }
 
+// Finalizador de splitmix64 (biyectivo, buena avalancha)
+static uint64_t mix64(uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+uint64_t Exp::combineHash(uint64_t seed, uint64_t v) {
+    // Nunca retorna 0 (reservado para "no apta para CSE")
+    uint64_t h = mix64(seed ^ mix64(v + 0x9e3779b97f4a7c15ULL));
+    return h ? h : 1;
+}
+
+static bool cseOperator(BinaryOp op) {
+    return op == PLUS_OP || op == MINUS_OP || op == MUL_OP || op == DIV_OP;
+}
+
+bool Exp::sameStructure(const Exp* a, const Exp* b) {
+    if (a == b) return true;
+    if (!a || !b || a->hash != b->hash || a->kind != b->kind) return false;
+    switch (a->kind) {
+        case ExpKind::NUMBER: return static_cast<const NumberExp*>(a)->value == static_cast<const NumberExp*>(b)->value;
+        case ExpKind::BOOL:   return static_cast<const BoolExp*>(a)->valor == static_cast<const BoolExp*>(b)->valor;
+        case ExpKind::ID:     return static_cast<const IdExp*>(a)->sym == static_cast<const IdExp*>(b)->sym;
+        case ExpKind::BINARY: {
+            const BinaryExp* x = static_cast<const BinaryExp*>(a);
+            const BinaryExp* y = static_cast<const BinaryExp*>(b);
+            return x->op == y->op && sameStructure(x->left, y->left) && sameStructure(x->right, y->right);
+        }
+        default: return false;
+    }
+}
+
+// ------------------ ExpTable ------------------
+bool ExpTable::shallowEqual(const Exp* a, const Exp* b) {
+    if (a->kind != b->kind) return false;
+    if (a->kind == ExpKind::BINARY) {
+        const BinaryExp* x = static_cast<const BinaryExp*>(a);
+        const BinaryExp* y = static_cast<const BinaryExp*>(b);
+        return x->op == y->op && x->left == y->left && x->right == y->right;
+    }
+    return Exp::sameStructure(a, b); // hojas
+}
+
+Exp* ExpTable::find(const Exp* probe) {
+    if (!probe->hash) return nullptr;
+    auto range = nodes.equal_range(probe->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (shallowEqual(it->second, probe)) { ++hits; return it->second; }
+    }
+    return nullptr;
+}
+
+void ExpTable::forget(SymbolId sym) {
+    IdExp probe(sym);
+    auto range = nodes.equal_range(probe.hash);
+    for (auto it = range.first; it != range.second;) {
+        if (shallowEqual(it->second, &probe)) it = nodes.erase(it);
+        else ++it;
+    }
+}
+
+void ExpTable::closeScope(size_t mark) {
+    while (bound.size() > mark) {
+        forget(bound.back());
+        bound.pop_back();
+    }
+}
+
 // ------------------ BinaryExp ------------------
 BinaryExp::BinaryExp(Exp* l, Exp* r, BinaryOp o)
-    : left(l), right(r), op(o) {}
+    : Exp(KIND), left(l), right(r), op(o) {
+    offset = l ? l->offset : 0;
+    if (l && r && l->hash && r->hash && cseOperator(o)) {
+        hash = combineHash(combineHash(combineHash(static_cast<uint64_t>(KIND), o), l->hash), r->hash);
+    }
+}
 
     
-BinaryExp::~BinaryExp() {
-    delete left;
-    delete right;
-}
+BinaryExp::~BinaryExp() {}
 
 
 
 // ------------------ NumberExp ------------------
-NumberExp::NumberExp(long long v) : value(v) {}
+NumberExp::NumberExp(long long v) : Exp(KIND), value(v) {
+    hash = combineHash(static_cast<uint64_t>(KIND), static_cast<uint64_t>(v));
+}
 
 NumberExp::~NumberExp() {}
 
 
 // ------------------idExp ------------------
-IdExp::IdExp(string v) : value(v) {}
+IdExp::IdExp(SymbolId s) : Exp(KIND), sym(s) {
+    hash = combineHash(static_cast<uint64_t>(KIND), s);
+}
+
+// ------------------ BoolExp ------------------
+BoolExp::BoolExp(int v) : Exp(KIND), valor(v) {
+    hash = combineHash(static_cast<uint64_t>(KIND), v ? 1 : 0);
+}
 
 IdExp::~IdExp() {}
 
@@ -55,18 +135,15 @@ PrintStm::~PrintStm(){}
 
 AssignStm::~AssignStm(){}
 
-Program::~Program() {
-    for (auto f : fdlist) delete f;
-    for (auto v : vdlist) delete v;
-    for (auto s : sdlist) delete s;
-}
+// Los nodos viven en la arena: su destructor libera todo de una vez
+Program::~Program() {}
 
-PrintStm::PrintStm(Exp* expresion){
+PrintStm::PrintStm(Exp* expresion) : Stm(KIND) {
     e=expresion;
 }
 
-AssignStm::AssignStm(string variable,Exp* expresion){
-    id = variable;
+AssignStm::AssignStm(SymbolId variable,Exp* expresion) : Stm(KIND) {
+    sym = variable;
     e = expresion;
 }
 
@@ -76,13 +153,13 @@ int Program::accept(Visitor* visitor) { return visitor->visit(this); }
 // Nuevos nodos de sentencias: implementaciones mínimas
 
 // ------------------ ArrayAccessExp ------------------
-ArrayAccessExp::ArrayAccessExp(Exp* a, Exp* i) : array(a), index(i) {}
-ArrayAccessExp::~ArrayAccessExp() { delete array; delete index; }
+ArrayAccessExp::ArrayAccessExp(Exp* a, Exp* i) : Exp(KIND), array(a), index(i) { offset = a ? a->offset : 0; }
+ArrayAccessExp::~ArrayAccessExp() {}
 int ArrayAccessExp::accept(Visitor* visitor) { return visitor->visit(this); }
 
 // ------------------ FieldAccessExp ------------------
-FieldAccessExp::FieldAccessExp(Exp* o, string f) : object(o), field(f) {}
-FieldAccessExp::~FieldAccessExp() { delete object; }
+FieldAccessExp::FieldAccessExp(Exp* o, string f) : Exp(KIND), object(o), field(f) { offset = o ? o->offset : 0; }
+FieldAccessExp::~FieldAccessExp() {}
 int FieldAccessExp::accept(Visitor* visitor) { return visitor->visit(this); }
 
 // ------------------ StructDec ------------------
@@ -115,6 +192,6 @@ int ForStm::accept(Visitor* visitor) { return visitor->visit(this); }
 int ReturnStm::accept(Visitor* visitor) { return visitor->visit(this); }
 
 // ------------------ FloatExp ------------------
-FloatExp::FloatExp(double v, bool d) : value(v), isDouble(d) {}
+FloatExp::FloatExp(double v, bool d) : Exp(KIND), value(v), isDouble(d) {}
 
 FloatExp::~FloatExp() {}
@@ -3,10 +3,12 @@
 
 #include <string>
 #include <unordered_map>
-#include <list>
 #include <ostream>
 #include <vector>
 #include "semantic_types.h"
+#include "interner.h"
+#include "arena.h"
+#include "small_vector.h"
 
 using namespace std;
 
@@ -29,14 +31,39 @@ enum BinaryOp {
     ASSIGN_OP // Added for assignment expressions
 };
 
+// Clase concreta de cada nodo. Se guarda en el propio nodo (campo kind)
+// para despachar con un switch o as<T>() en lugar de dynamic_cast.
+enum class ExpKind : uint8_t {
+    BINARY, NUMBER, FLOAT, BOOL, ID, FCALL, ARRAY_ACCESS, FIELD_ACCESS, STRUCT_INIT
+};
+
+enum class StmKind : uint8_t {
+    BLOCK, LET, IF, WHILE, FOR, PRINT, ASSIGN, RETURN
+};
+
 // ============================================================
 // Clase abstracta Exp
 // ============================================================
 class Exp {
 public:
+    const ExpKind kind;
+    // Tipo del valor que deja en %rax, fijado por TypeCheckerVisitor. Con
+    // hash-consing un nodo compartido guarda un solo tipo por función.
+    Type::TType type = Type::NOTYPE;
+    uint32_t offset = 0; // inicio en el fuente (bytes); línea/columna vía LineTable
+    uint64_t hash = 0;   // hash estructural fijado al construir; 0 = no apta para CSE
+
+    explicit Exp(ExpKind k) : kind(k) {}
     virtual int  accept(Visitor* visitor) = 0;
     virtual ~Exp() = 0;
     static string binopToChar(BinaryOp op);
+
+    // Igualdad estructural de dos expresiones aptas para CSE (hash != 0).
+    // Compara primero hash y puntero, así que con hash-consing es O(1).
+    static bool sameStructure(const Exp* a, const Exp* b);
+
+protected:
+    static uint64_t combineHash(uint64_t seed, uint64_t v);
 };
 
 // ============================================================
@@ -44,6 +71,7 @@ public:
 // ============================================================
 class BinaryExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::BINARY;
     Exp* left;
     Exp* right;
     BinaryOp op;
@@ -59,6 +87,7 @@ public:
 // ============================================================
 class NumberExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::NUMBER;
     long long value;
 
     NumberExp(long long v);
@@ -72,9 +101,11 @@ public:
 // ============================================================
 class IdExp : public Exp {
 public:
-    string value;
+    static const ExpKind KIND = ExpKind::ID;
+    SymbolId sym; // nombre internado
 
-    IdExp(string v);
+    IdExp(SymbolId s);
+    const string& value() const { return global_interner().name(sym); }
     ~IdExp();
 
     int accept(Visitor* visitor);
@@ -85,10 +116,12 @@ public:
 // ============================================================
 class FcallExp : public Exp {
 public:
-    string nombre;
-    list<Exp*> argumentos;
+    static const ExpKind KIND = ExpKind::FCALL;
+    SymbolId sym; // nombre de la función internado
+    SmallVector<Exp*, 4> argumentos;
 
-    FcallExp(){};
+    FcallExp() : Exp(KIND), sym(kNoSymbol) {};
+    const string& nombre() const { return global_interner().name(sym); }
     ~FcallExp(){};
 
     int accept(Visitor* visitor);
@@ -99,9 +132,10 @@ public:
 // ============================================================
 class BoolExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::BOOL;
     int valor;
 
-    BoolExp(){};
+    BoolExp(int v = 0);
     ~BoolExp(){};
 
     int accept(Visitor* visitor);
@@ -113,6 +147,10 @@ public:
 // ============================================================
 class Stm {
 public:
+    const StmKind kind;
+    uint32_t offset = 0; // inicio en el fuente (bytes); línea/columna vía LineTable
+
+    explicit Stm(StmKind k) : kind(k) {}
     virtual int accept(Visitor* visitor) = 0;
     virtual ~Stm() = 0;
 };
@@ -123,9 +161,10 @@ public:
 // Bloque de sentencias (equivalente a Block en la gramática Rust)
 class BlockStm : public Stm {
 public:
-    list<Stm*> statements;
+    static const StmKind KIND = StmKind::BLOCK;
+    SmallVector<Stm*, 4> statements;
 
-    BlockStm() {}
+    BlockStm() : Stm(KIND) {}
     ~BlockStm() {}
 
     int accept(Visitor* visitor);
@@ -134,13 +173,16 @@ public:
 // Sentencia let (declaración de variable)
 class LetStm : public Stm {
 public:
+    static const StmKind KIND = StmKind::LET;
     bool mutable_flag;
-    string name;
+    SymbolId sym;     // nombre de la variable internado
     string type_name; // i32, bool, identificador de tipo, etc.
     Exp* init;        // puede ser null
+    ResolvedType resolved; // type_name resuelto (TypeCheckerVisitor)
 
-    LetStm(bool mut, const string& n, const string& t, Exp* e)
-        : mutable_flag(mut), name(n), type_name(t), init(e) {}
+    LetStm(bool mut, SymbolId n, const string& t, Exp* e)
+        : Stm(KIND), mutable_flag(mut), sym(n), type_name(t), init(e) {}
+    const string& name() const { return global_interner().name(sym); }
     ~LetStm() {}
 
     int accept(Visitor* visitor);
@@ -149,12 +191,13 @@ public:
 // If / Else
 class IfStm : public Stm {
 public:
+    static const StmKind KIND = StmKind::IF;
     Exp* condition;
     BlockStm* thenBlock;
     BlockStm* elseBlock; // puede ser null
 
     IfStm(Exp* cond, BlockStm* thenB, BlockStm* elseB)
-        : condition(cond), thenBlock(thenB), elseBlock(elseB) {}
+        : Stm(KIND), condition(cond), thenBlock(thenB), elseBlock(elseB) {}
     ~IfStm() {}
 
     int accept(Visitor* visitor);
@@ -163,10 +206,11 @@ public:
 // While
 class WhileStm : public Stm {
 public:
+    static const StmKind KIND = StmKind::WHILE;
     Exp* condition;
     BlockStm* body;
 
-    WhileStm(Exp* cond, BlockStm* b) : condition(cond), body(b) {}
+    WhileStm(Exp* cond, BlockStm* b) : Stm(KIND), condition(cond), body(b) {}
     ~WhileStm() {}
 
     int accept(Visitor* visitor);
@@ -175,23 +219,27 @@ public:
 // For de rango: for i in a..b { body }
 class ForStm : public Stm {
 public:
-    string iteratorName;
+    static const StmKind KIND = StmKind::FOR;
+    SymbolId iterator; // nombre del iterador internado
     Exp* start;
     Exp* end;
     BlockStm* body;
 
-    ForStm(const string& it, Exp* s, Exp* e, BlockStm* b)
-        : iteratorName(it), start(s), end(e), body(b) {}
+    ForStm(SymbolId it, Exp* s, Exp* e, BlockStm* b)
+        : Stm(KIND), iterator(it), start(s), end(e), body(b) {}
+    const string& iteratorName() const { return global_interner().name(iterator); }
     ~ForStm() {}
 
     int accept(Visitor* visitor);
 };
 class AssignStm : public Stm {
 public:
-    string id;
+    static const StmKind KIND = StmKind::ASSIGN;
+    SymbolId sym; // variable destino internada ("_" para expresión descartada)
     Exp* e;
 
-    AssignStm(string, Exp*);
+    AssignStm(SymbolId, Exp*);
+    const string& id() const { return global_interner().name(sym); }
     ~AssignStm();
 
     int accept(Visitor* visitor);
@@ -199,6 +247,7 @@ public:
 
 class PrintStm : public Stm {
 public:
+    static const StmKind KIND = StmKind::PRINT;
     Exp* e;
 
     PrintStm(Exp*);
@@ -209,9 +258,10 @@ public:
 
 class ReturnStm : public Stm {
 public:
+    static const StmKind KIND = StmKind::RETURN;
     Exp* e;
 
-    ReturnStm() {};
+    ReturnStm() : Stm(KIND), e(nullptr) {};
     ~ReturnStm() {};
 
     int accept(Visitor* visitor);
@@ -223,7 +273,7 @@ public:
 class VarDec {
 public:
     string tipo;
-    list<string> variables;
+    SmallVector<string, 2> variables;
 
     VarDec() {};
     ~VarDec() {};
@@ -232,8 +282,8 @@ public:
 
 class Body {
 public:
-    list<Stm*> stmlist;
-    list<VarDec*> vdlist;
+    SmallVector<Stm*, 1> stmlist;   // el parser deja un único BlockStm
+    SmallVector<VarDec*, 2> vdlist;
 
     Body() {};
     ~Body() {};
@@ -244,9 +294,14 @@ class FunDec {
 public:
     string tipo;
     string nombre;
+    bool isConst = false;      // const fn: evaluable en compilación (ConstEvaluator)
     vector<string> Tparametros;
-    vector<string> Nparametros;
-    Body* cuerpo;
+    vector<SymbolId> Nparametros;
+    vector<ResolvedType> paramTypes; // Tparametros resueltos (TypeCheckerVisitor)
+    Body* cuerpo = nullptr;    // nullptr mientras el cuerpo esté diferido (Parser::parseBody)
+    uint32_t offset = 0;
+    uint32_t bodyBegin = 0;    // índice del '{' del cuerpo en el TokenBuffer
+    uint32_t bodyEnd = 0;      // índice del '}' que lo cierra
 
     FunDec() {};
     ~FunDec() {};
@@ -257,28 +312,48 @@ class StructDec {
 public:
     string name;
     vector<pair<string, string>> fields; // name, type
+    uint32_t offset = 0;
 
     StructDec(string n) : name(n) {}
     ~StructDec() {}
     int accept(Visitor* visitor);
 };
 
+// const NAME: T = expr; (el valor lo calcula ConstEvaluator)
+class ConstDec {
+public:
+    SymbolId sym;
+    string tipo;
+    Exp* init;
+    uint32_t offset = 0;
+
+    ConstDec(SymbolId s, const string& t, Exp* e) : sym(s), tipo(t), init(e) {}
+    const string& name() const { return global_interner().name(sym); }
+    ~ConstDec() {}
+};
+
 class TypeAlias {
 public:
     string alias;
     string type;
+    uint32_t offset = 0;
 
     TypeAlias(string a, string t) : alias(a), type(t) {}
     ~TypeAlias() {}
     int accept(Visitor* visitor);
 };
 
+// El programa es dueño de la arena donde viven todos sus nodos:
+// los hijos no se liberan uno a uno, todo se suelta al destruir Program.
 class Program {
 public:
-    list<FunDec*> fdlist;
-    list<VarDec*> vdlist;
-    list<StructDec*> sdlist; // Added struct list
-    list<TypeAlias*> talist; // Added type alias list
+    Arena arena;
+    vector<FunDec*> fdlist;
+    vector<VarDec*> vdlist;
+    vector<StructDec*> sdlist; // Added struct list
+    vector<TypeAlias*> talist; // Added type alias list
+    vector<ConstDec*> cdlist;  // const items, en orden de fuente
+    bool sharedExps = false;   // parseado con hash-consing: una Exp puede tener varios padres
 
     Program();
     ~Program();
@@ -291,6 +366,7 @@ public:
 // ============================================================
 class ArrayAccessExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::ARRAY_ACCESS;
     Exp* array;
     Exp* index;
 
@@ -305,6 +381,7 @@ public:
 // ============================================================
 class FieldAccessExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::FIELD_ACCESS;
     Exp* object;
     string field;
 
@@ -319,11 +396,13 @@ public:
 // ============================================================
 class StructInitExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::STRUCT_INIT;
     string name;
     vector<pair<string, Exp*>> fields;
+    TypeId structType = kNoType; // name resuelto (TypeCheckerVisitor)
 
-    StructInitExp(string n) : name(n) {}
-    ~StructInitExp() { for(auto f : fields) delete f.second; }
+    StructInitExp(string n) : Exp(KIND), name(n) {}
+    ~StructInitExp() {}
 
     int accept(Visitor* visitor);
 };
@@ -333,6 +412,7 @@ public:
 // ============================================================
 class FloatExp : public Exp {
 public:
+    static const ExpKind KIND = ExpKind::FLOAT;
     double value;
     bool isDouble; // true for f64, false for f32
 
@@ -342,4 +422,51 @@ public:
     int accept(Visitor* visitor);
 };
 
+// ============================================================
+// Tabla de hash-consing: find(probe) retorna un nodo ya registrado
+// con la misma estructura que probe (que puede vivir en la pila).
+// Sólo deduplica expresiones puras (hash != 0: números, booleanos,
+// ids y + - * / sobre ellas); como los hijos ya pasaron por la tabla
+// basta compararlos por puntero. El nodo compartido conserva el
+// offset de su primera aparición.
+//
+// Un IdExp sólo se comparte dentro de un mismo binding: el tipo se
+// anota en el nodo y un let que sombrea el nombre puede cambiarlo.
+// bind(sym) (let, iterador de for) y closeScope (fin del bloque)
+// olvidan el IdExp de sym; los usos siguientes crean uno nuevo y los
+// padres registrados con el anterior ya no coinciden con ellos.
+// ============================================================
+class ExpTable {
+private:
+    unordered_multimap<uint64_t, Exp*> nodes;
+    vector<SymbolId> bound; // nombres ligados en los scopes abiertos
+    size_t hits = 0;
+
+    static bool shallowEqual(const Exp* a, const Exp* b);
+    void forget(SymbolId sym);
+
+public:
+    Exp* find(const Exp* probe);
+    void insert(Exp* e) { if (e->hash) nodes.emplace(e->hash, e); }
+
+    void bind(SymbolId sym) { forget(sym); bound.push_back(sym); }
+    size_t openScope() const { return bound.size(); }
+    void closeScope(size_t mark);
+
+    size_t size() const { return nodes.size(); }
+    size_t reused() const { return hits; } // búsquedas resueltas con un nodo existente
+    void clear() { nodes.clear(); bound.clear(); }
+};
+
+// ============================================================
+// Downcast por etiqueta: compara kind en lugar de dynamic_cast
+// (sin RTTI). Retorna nullptr si el nodo no es de la clase T.
+// Para varias clases, usar directamente switch (n->kind).
+// ============================================================
+template <typename T>
+inline T* as(Exp* e) { return e && e->kind == T::KIND ? static_cast<T*>(e) : nullptr; }
+
+template <typename T>
+inline T* as(Stm* s) { return s && s->kind == T::KIND ? static_cast<T*>(s) : nullptr; }
+
 #endif // AST_H
@@ -0,0 +1,123 @@
+#include "ast_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <direct.h>
+#include <process.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char kCacheMagic[4] = {'A', 'S', 'T', 'C'};
+
+uint64_t mix64(uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t checksum; // del FlatAst serializado que sigue
+    uint64_t hash;
+    uint64_t size;
+};
+
+uint32_t payloadChecksum(const string& payload) {
+    return static_cast<uint32_t>(contentHash(payload.data(), payload.size()));
+}
+
+} // namespace
+
+uint64_t contentHash(const char* data, size_t size) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+        h = mix64(h ^ w) + 0x9e3779b97f4a7c15ULL;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, size - i);
+    return mix64(h ^ tail);
+}
+
+AstCache::AstCache(const string& directory) : dir(directory) {
+    // Si ya existe no pasa nada
+#ifndef _WIN32
+    mkdir(dir.c_str(), 0755);
+#else
+    _mkdir(dir.c_str());
+#endif
+}
+
+string AstCache::pathFor(uint64_t hash) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.fast", static_cast<unsigned long long>(hash));
+    return dir + "/" + name;
+}
+
+bool AstCache::load(const char* source, size_t size, FlatAst& out) const {
+    uint64_t hash = contentHash(source, size);
+    ifstream in(pathFor(hash), ios::binary);
+    if (!in.is_open()) return false;
+
+    CacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+        header.hash != hash || header.size != size) {
+        return false;
+    }
+    // Una entrada corrupta (checksum, índices fuera de rango, largos
+    // imposibles) o de otra versión del formato cuenta como fallo
+    try {
+        stringstream payload;
+        payload << in.rdbuf();
+        if (payloadChecksum(payload.str()) != header.checksum) return false;
+        out = FlatAst::read(payload);
+    } catch (const exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool AstCache::store(const char* source, size_t size, const FlatAst& ast) const {
+    ostringstream payload;
+    ast.write(payload);
+    CacheHeader header;
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.checksum = payloadChecksum(payload.str());
+    header.hash = contentHash(source, size);
+    header.size = size;
+
+    // Se escribe a un temporal propio del proceso y se renombra: un lector
+    // concurrente nunca ve una entrada a medio escribir
+    string path = pathFor(header.hash);
+#ifndef _WIN32
+    string tmp = path + "." + to_string(getpid()) + ".tmp";
+#else
+    string tmp = path + "." + to_string(_getpid()) + ".tmp";
+#endif
+    {
+        ofstream os(tmp, ios::binary | ios::trunc);
+        if (!os.is_open()) return false;
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os << payload.str();
+        if (!os) { os.close(); remove(tmp.c_str()); return false; }
+    }
+#ifdef _WIN32
+    remove(path.c_str()); // rename no reemplaza en Windows
+#endif
+    if (rename(tmp.c_str(), path.c_str()) != 0) { remove(tmp.c_str()); return false; }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "flat_ast.h"
+
+using namespace std;
+
+// ===========================================================
+//  Cache en disco del AST parseado, indexado por el hash del
+//  contenido del fuente. Cada entrada es un archivo
+//  <dir>/<hash>.fast con una cabecera (hash y tamaño del fuente)
+//  seguida del FlatAst serializado, así un segundo compilado del
+//  mismo fuente no lexea ni parsea: lee las columnas de una vez.
+//  Una entrada ilegible, corrupta (checksum o índices que no
+//  cierran) o de otra versión cuenta como fallo.
+// ===========================================================
+
+// Hash de 64 bits del contenido (8 bytes por paso)
+uint64_t contentHash(const char* data, size_t size);
+
+class AstCache {
+private:
+    string dir;
+
+    string pathFor(uint64_t hash) const;
+
+public:
+    explicit AstCache(const string& directory);
+
+    // true si había una entrada válida para este fuente
+    bool load(const char* source, size_t size, FlatAst& out) const;
+
+    // Guarda (reemplaza) la entrada; retorna false si no se pudo escribir
+    bool store(const char* source, size_t size, const FlatAst& ast) const;
+};
+
+#endif // AST_CACHE_H
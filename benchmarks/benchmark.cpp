@@ -0,0 +1,1165 @@
+// Benchmark de Scanner y Parser sobre programas sintéticos.
+// Genera un programa válido del subconjunto Rust soportado, lo lexea y
+// parsea varias veces (completo y sólo firmas), compara el recorrido del
+// AST de punteros con el del AST plano (flat_ast.h), el despacho por
+// dynamic_cast con el de la etiqueta kind, las claves de CSE de texto con
+// el hash estructural y el parseo de expresiones por cascada de niveles
+// con el de precedence climbing, el reparseo incremental de una edición
+// con el lexeo y parseo completo, la tabla de símbolos por scopes con la
+// de un mapa por scope, mide el análisis semántico, e imprime los resultados
+// en JSON con claves en orden fijo (schema_version) para poder compararlos
+// entre versiones.
+//
+// kSchemaVersion sube cada vez que cambia la forma del reporte (secciones o
+// campos agregados, renombrados o quitados); quien compare dos reportes debe
+// mirarla antes que los valores.
+//   1: input, scanner, parser
+//   2: traversal, dispatch, expressions, signatures, parallel_parse,
+//      hash_consing, cse_keys, ast_cache, incremental, symbols, types,
+//      frames, struct_layout
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "../scanner.h"
+#include "../parser.h"
+#include "../ast.h"
+#include "../visitor.h"
+#include "../flat_ast.h"
+#include "../ast_cache.h"
+#include "../incremental.h"
+#include "../environment.h"
+
+using namespace std;
+
+static const int kSchemaVersion = 2;
+
+// =============================================================================
+// Generador de programas sintéticos
+// =============================================================================
+
+struct GenConfig {
+    long lines = 1000;     // líneas aproximadas a generar
+    int depth = 4;         // profundidad de anidamiento de expresiones
+    int structs = 8;       // número de structs
+    int stmtsPerFn = 12;   // sentencias por función (controla cuántas funciones)
+    int chain = 0;         // >0: operandos por expresión plana (entrada cargada de expresiones)
+    unsigned threads = thread::hardware_concurrency(); // hilos del parseo paralelo
+    unsigned seed = 1;
+};
+
+class ProgramGenerator {
+private:
+    const GenConfig& cfg;
+    ostringstream out;
+    long lineCount = 0;
+    unsigned state;
+
+    unsigned next() {
+        state = state * 1103515245u + 12345u;
+        return (state >> 16) & 0x7fff;
+    }
+
+    void line(const string& s) {
+        out << s << '\n';
+        ++lineCount;
+    }
+
+    // Expresión aritmética anidada sobre los nombres disponibles
+    string expr(int depth, const vector<string>& vars) {
+        if (depth <= 0 || next() % 4 == 0) {
+            if (vars.empty() || next() % 3 == 0) return to_string(next() % 1000);
+            return vars[next() % vars.size()];
+        }
+        static const char* ops[] = {"+", "-", "*", "+", "-"};
+        string l = expr(depth - 1, vars);
+        string r = expr(depth - 1, vars);
+        return "(" + l + " " + ops[next() % 5] + " " + r + ")";
+    }
+
+    // Cadena sin paréntesis que mezcla todas las precedencias aritméticas
+    string chain(const vector<string>& vars) {
+        static const char* ops[] = {"+", "-", "*", "/", "+", "*"};
+        string s = expr(1, vars);
+        for (int i = 1; i < cfg.chain; ++i) {
+            s += string(" ") + ops[next() % 6] + " ";
+            s += (next() % 8 == 0) ? "(" + expr(1, vars) + " + " + expr(1, vars) + ")" : expr(0, vars);
+        }
+        return s;
+    }
+
+    // Inicializador de un let: cadena plana si se pidió --chain
+    string init(const vector<string>& vars) {
+        return cfg.chain > 0 ? chain(vars) : expr(cfg.depth, vars);
+    }
+
+    string cond(const vector<string>& vars) {
+        static const char* rel[] = {"<", ">", "<=", ">=", "==", "!="};
+        return "(" + expr(1, vars) + " " + rel[next() % 6] + " " + expr(1, vars) + ")";
+    }
+
+    void genStruct(int idx) {
+        line("struct S" + to_string(idx) + " {");
+        line("    a: i32;");
+        line("    b: i64;");
+        line("    c: i32;");
+        line("}");
+        line("");
+    }
+
+    void genFunction(int idx) {
+        vector<string> vars = {"p0", "p1"};
+        line("fn func" + to_string(idx) + "(p0: i64, p1: i64) -> i64 {");
+        for (int s = 0; s < cfg.stmtsPerFn; ++s) {
+            string v = "v" + to_string(s);
+            // Con --chain dos de cada tres sentencias son lets con cadenas largas
+            unsigned pick = next() % 6;
+            if (cfg.chain > 0 && next() % 3 != 0) pick = 0;
+            switch (pick) {
+                case 0:
+                case 1:
+                    line("    let mut " + v + ": i64 = " + init(vars) + ";");
+                    vars.push_back(v);
+                    break;
+                case 2:
+                    line("    let mut " + v + ": i64 = 0;");
+                    line("    while " + cond(vars) + " {");
+                    line("        " + v + " = " + v + " + " + expr(cfg.depth / 2, vars) + ";");
+                    line("        " + v + " += 1;");
+                    line("    }");
+                    vars.push_back(v);
+                    break;
+                case 3:
+                    line("    let mut " + v + ": i64 = 0;");
+                    line("    for i in 0.." + to_string(1 + next() % 50) + " {");
+                    line("        " + v + " = " + v + " + i * " + expr(1, vars) + ";");
+                    line("    }");
+                    vars.push_back(v);
+                    break;
+                case 4: {
+                    string st = "S" + to_string(next() % (cfg.structs > 0 ? cfg.structs : 1));
+                    if (cfg.structs <= 0) { line("    println!(\"{}\", " + expr(cfg.depth, vars) + ");"); break; }
+                    line("    let " + v + ": " + st + " = " + st + " { a: 1, b: " + expr(1, vars) + ", c: 3 };");
+                    line("    println!(\"{}\", " + v + ".b);");
+                    break;
+                }
+                default:
+                    line("    if " + cond(vars) + " {");
+                    line("        println!(\"{}\", " + expr(cfg.depth, vars) + ");");
+                    line("    } else {");
+                    line("        println!(\"{}\", " + expr(cfg.depth, vars) + ");");
+                    line("    }");
+                    break;
+            }
+        }
+        if (idx > 0) {
+            line("    return func" + to_string(next() % idx) + "(" + vars.back() + ", " + expr(2, vars) + ");");
+        } else {
+            line("    return " + vars.back() + ";");
+        }
+        line("}");
+        line("");
+    }
+
+public:
+    explicit ProgramGenerator(const GenConfig& c) : cfg(c), state(c.seed) {}
+
+    string generate() {
+        for (int i = 0; i < cfg.structs; ++i) genStruct(i);
+        line("type Entero = i64;");
+        line("");
+        int fn = 0;
+        while (lineCount < cfg.lines) genFunction(fn++);
+        line("fn main() {");
+        line("    println!(\"{}\", func" + to_string(fn - 1) + "(1, 2));");
+        line("}");
+        return out.str();
+    }
+
+    long lines() const { return lineCount; }
+};
+
+// =============================================================================
+// Conteo de nodos del AST
+// =============================================================================
+
+class NodeCounter : public Visitor {
+public:
+    long nodes = 0;
+
+    int visit(Program* p) override {
+        ++nodes;
+        for (auto s : p->sdlist) s->accept(this);
+        for (auto t : p->talist) t->accept(this);
+        for (auto f : p->fdlist) f->accept(this);
+        return 0;
+    }
+    int visit(FunDec* f) override { ++nodes; if (f->cuerpo) f->cuerpo->accept(this); return 0; }
+    int visit(Body* b) override { ++nodes; for (auto s : b->stmlist) s->accept(this); return 0; }
+    int visit(BlockStm* b) override { ++nodes; for (auto s : b->statements) s->accept(this); return 0; }
+    int visit(LetStm* s) override { ++nodes; if (s->init) s->init->accept(this); return 0; }
+    int visit(IfStm* s) override {
+        ++nodes;
+        s->condition->accept(this);
+        s->thenBlock->accept(this);
+        if (s->elseBlock) s->elseBlock->accept(this);
+        return 0;
+    }
+    int visit(WhileStm* s) override { ++nodes; s->condition->accept(this); s->body->accept(this); return 0; }
+    int visit(ForStm* s) override {
+        ++nodes;
+        s->start->accept(this);
+        s->end->accept(this);
+        s->body->accept(this);
+        return 0;
+    }
+    int visit(PrintStm* s) override { ++nodes; if (s->e) s->e->accept(this); return 0; }
+    int visit(AssignStm* s) override { ++nodes; if (s->e) s->e->accept(this); return 0; }
+    int visit(ReturnStm* s) override { ++nodes; if (s->e) s->e->accept(this); return 0; }
+    int visit(VarDec*) override { ++nodes; return 0; }
+    int visit(StructDec*) override { ++nodes; return 0; }
+    int visit(TypeAlias*) override { ++nodes; return 0; }
+    int visit(StructInitExp* e) override { ++nodes; for (auto& f : e->fields) f.second->accept(this); return 0; }
+    int visit(BinaryExp* e) override { ++nodes; e->left->accept(this); e->right->accept(this); return 0; }
+    int visit(NumberExp*) override { ++nodes; return 0; }
+    int visit(FloatExp*) override { ++nodes; return 0; }
+    int visit(BoolExp*) override { ++nodes; return 0; }
+    int visit(IdExp*) override { ++nodes; return 0; }
+    int visit(FcallExp* e) override { ++nodes; for (auto a : e->argumentos) a->accept(this); return 0; }
+    int visit(ArrayAccessExp* e) override { ++nodes; e->array->accept(this); e->index->accept(this); return 0; }
+    int visit(FieldAccessExp* e) override { ++nodes; e->object->accept(this); return 0; }
+};
+
+// Junta las raíces de expresión de todas las sentencias (sin bajar a los hijos)
+class ExpRootCollector : public NodeCounter {
+public:
+    vector<Exp*> roots;
+
+    int visit(StructInitExp* e) override { roots.push_back(e); return 0; }
+    int visit(BinaryExp* e) override { roots.push_back(e); return 0; }
+    int visit(NumberExp* e) override { roots.push_back(e); return 0; }
+    int visit(FloatExp* e) override { roots.push_back(e); return 0; }
+    int visit(BoolExp* e) override { roots.push_back(e); return 0; }
+    int visit(IdExp* e) override { roots.push_back(e); return 0; }
+    int visit(FcallExp* e) override { roots.push_back(e); return 0; }
+    int visit(ArrayAccessExp* e) override { roots.push_back(e); return 0; }
+    int visit(FieldAccessExp* e) override { roots.push_back(e); return 0; }
+};
+
+// =============================================================================
+// Tabla de símbolos: las operaciones de scope que hace la generación de
+// código (un scope por función, bloque y for; let declara, cada uso de
+// variable busca) se graban una vez y se reproducen sobre dos tablas.
+// =============================================================================
+
+class ScopeTrace : public NodeCounter {
+public:
+    enum Op : uint8_t { CLEAR, PUSH, POP, DECLARE, LOOKUP };
+    vector<pair<Op, SymbolId>> ops;
+
+    int visit(FunDec* f) override {
+        ops.push_back({CLEAR, kNoSymbol});
+        ops.push_back({PUSH, kNoSymbol});
+        for (SymbolId p : f->Nparametros) ops.push_back({DECLARE, p});
+        return NodeCounter::visit(f);
+    }
+    int visit(BlockStm* b) override {
+        ops.push_back({PUSH, kNoSymbol});
+        NodeCounter::visit(b);
+        ops.push_back({POP, kNoSymbol});
+        return 0;
+    }
+    int visit(ForStm* s) override {
+        ops.push_back({PUSH, kNoSymbol});
+        ops.push_back({DECLARE, s->iterator});
+        NodeCounter::visit(s);
+        ops.push_back({POP, kNoSymbol});
+        return 0;
+    }
+    int visit(LetStm* s) override {
+        NodeCounter::visit(s);
+        ops.push_back({DECLARE, s->sym});
+        return 0;
+    }
+    int visit(AssignStm* s) override {
+        NodeCounter::visit(s);
+        ops.push_back({LOOKUP, s->sym});
+        return 0;
+    }
+    int visit(IdExp* e) override {
+        ops.push_back({LOOKUP, e->sym});
+        return NodeCounter::visit(e);
+    }
+};
+
+// La tabla anterior: un unordered_map por scope, buscando de adentro hacia afuera
+class MapPerScopeEnv {
+private:
+    vector<unordered_map<SymbolId, SymbolInfo>> scopes;
+
+public:
+    void clear() { scopes.clear(); }
+    void push_scope() { scopes.emplace_back(); }
+    void pop_scope() { scopes.pop_back(); }
+    bool declare(SymbolId name, const SymbolInfo& value) {
+        if (scopes.empty()) push_scope();
+        scopes.back()[name] = value;
+        return true;
+    }
+    SymbolInfo* lookup(SymbolId name) {
+        for (size_t i = scopes.size(); i-- > 0;) {
+            auto it = scopes[i].find(name);
+            if (it != scopes[i].end()) return &it->second;
+        }
+        return nullptr;
+    }
+};
+
+// Reproduce la traza y retorna un checksum de los offsets encontrados
+template <typename Env>
+static long replay_scopes(const ScopeTrace& trace, Env& env) {
+    long sum = 0;
+    int nextOffset = 0;
+    for (const auto& op : trace.ops) {
+        switch (op.first) {
+            case ScopeTrace::CLEAR: env.clear(); break;
+            case ScopeTrace::PUSH: env.push_scope(); break;
+            case ScopeTrace::POP: env.pop_scope(); break;
+            case ScopeTrace::DECLARE: {
+                SymbolInfo info;
+                info.offset = nextOffset -= 8;
+                env.declare(op.second, info);
+                break;
+            }
+            case ScopeTrace::LOOKUP:
+                if (SymbolInfo* info = env.lookup(op.second)) sum += info->offset;
+                else sum += 1;
+                break;
+        }
+    }
+    return sum;
+}
+
+// =============================================================================
+// Frames: slots que se reservarían sumando cada declaración de la función
+// (sin reutilizar scopes), para comparar con el pico de TypeCheckerVisitor.
+// La misma cuenta sobre el AST plano y sobre el de punteros mide además el
+// costo de recorrer cada representación (sección traversal).
+// =============================================================================
+
+static long declared_exp_slots(const FlatAst& ast, TypeTable& types, FlatAst::Index exp) {
+    if (exp == FlatAst::kNull) return 0;
+    FlatAst::Index a = ast.expA[exp], b = ast.expB[exp], c = ast.expC[exp];
+    long slots = 0;
+    switch (ast.expKind[exp]) {
+        case ExpKind::BINARY:
+            return declared_exp_slots(ast, types, a) + declared_exp_slots(ast, types, b);
+        case ExpKind::FCALL:
+            for (FlatAst::Index k = 0; k < c; k++) slots += declared_exp_slots(ast, types, ast.lists[b + k]);
+            return slots;
+        case ExpKind::STRUCT_INIT: {
+            const TypeDesc& desc = types.get(types.intern(ast.strings[a]));
+            if (desc.kind == TypeDesc::STRUCT) slots = (desc.size + 7) / 8;
+            for (FlatAst::Index k = 0; k < c; k++) slots += declared_exp_slots(ast, types, ast.lists[b + 2 * k + 1]);
+            return slots;
+        }
+        default:
+            return 0;
+    }
+}
+
+static long declared_slots(const FlatAst& ast, TypeTable& types, FlatAst::Index stm) {
+    if (stm == FlatAst::kNull) return 0;
+    FlatAst::Index a = ast.stmA[stm], b = ast.stmB[stm], c = ast.stmC[stm], d = ast.stmD[stm];
+    long slots = 0;
+    switch (ast.stmKind[stm]) {
+        case StmKind::BLOCK:
+            for (FlatAst::Index k = 0; k < b; k++) slots += declared_slots(ast, types, ast.lists[a + k]);
+            return slots;
+        case StmKind::LET:
+            return (types.frameSize(types.intern(ast.strings[b])) + 7) / 8 + declared_exp_slots(ast, types, c);
+        case StmKind::IF:
+            return declared_exp_slots(ast, types, a) + declared_slots(ast, types, b) + declared_slots(ast, types, c);
+        case StmKind::WHILE:
+            return declared_exp_slots(ast, types, a) + declared_slots(ast, types, b);
+        case StmKind::FOR:
+            return 1 + declared_exp_slots(ast, types, b) + declared_exp_slots(ast, types, c) +
+                   declared_slots(ast, types, d);
+        case StmKind::PRINT:
+        case StmKind::RETURN:
+            return declared_exp_slots(ast, types, a);
+        case StmKind::ASSIGN:
+            return declared_exp_slots(ast, types, b);
+    }
+    return 0;
+}
+
+static long declared_frame_slots(const FlatAst& ast, TypeTable& types) {
+    long total = 0;
+    for (auto& function : ast.functions) {
+        total += static_cast<long>(function.Nparametros.size());
+        for (auto& vd : function.vdlist) total += static_cast<long>(vd.variables.size());
+        for (FlatAst::Index k = 0; k < function.bodyCount; k++) {
+            total += declared_slots(ast, types, ast.lists[function.bodyStart + k]);
+        }
+    }
+    return total;
+}
+
+static long declared_exp_slots(Exp* e, TypeTable& types) {
+    if (!e) return 0;
+    long slots = 0;
+    switch (e->kind) {
+        case ExpKind::BINARY: {
+            BinaryExp* b = static_cast<BinaryExp*>(e);
+            return declared_exp_slots(b->left, types) + declared_exp_slots(b->right, types);
+        }
+        case ExpKind::FCALL:
+            for (Exp* arg : static_cast<FcallExp*>(e)->argumentos) slots += declared_exp_slots(arg, types);
+            return slots;
+        case ExpKind::STRUCT_INIT: {
+            StructInitExp* init = static_cast<StructInitExp*>(e);
+            const TypeDesc& desc = types.get(types.intern(init->name));
+            if (desc.kind == TypeDesc::STRUCT) slots = (desc.size + 7) / 8;
+            for (auto& field : init->fields) slots += declared_exp_slots(field.second, types);
+            return slots;
+        }
+        default:
+            return 0;
+    }
+}
+
+static long declared_slots(Stm* s, TypeTable& types) {
+    if (!s) return 0;
+    long slots = 0;
+    switch (s->kind) {
+        case StmKind::BLOCK:
+            for (Stm* child : static_cast<BlockStm*>(s)->statements) slots += declared_slots(child, types);
+            return slots;
+        case StmKind::LET: {
+            LetStm* let = static_cast<LetStm*>(s);
+            return (types.frameSize(types.intern(let->type_name)) + 7) / 8 + declared_exp_slots(let->init, types);
+        }
+        case StmKind::IF: {
+            IfStm* i = static_cast<IfStm*>(s);
+            return declared_exp_slots(i->condition, types) + declared_slots(i->thenBlock, types) +
+                   declared_slots(i->elseBlock, types);
+        }
+        case StmKind::WHILE: {
+            WhileStm* w = static_cast<WhileStm*>(s);
+            return declared_exp_slots(w->condition, types) + declared_slots(w->body, types);
+        }
+        case StmKind::FOR: {
+            ForStm* f = static_cast<ForStm*>(s);
+            return 1 + declared_exp_slots(f->start, types) + declared_exp_slots(f->end, types) +
+                   declared_slots(f->body, types);
+        }
+        case StmKind::PRINT:
+            return declared_exp_slots(static_cast<PrintStm*>(s)->e, types);
+        case StmKind::RETURN:
+            return declared_exp_slots(static_cast<ReturnStm*>(s)->e, types);
+        case StmKind::ASSIGN:
+            return declared_exp_slots(static_cast<AssignStm*>(s)->e, types);
+    }
+    return 0;
+}
+
+static long declared_frame_slots(Program* program, TypeTable& types) {
+    long total = 0;
+    for (FunDec* function : program->fdlist) {
+        total += static_cast<long>(function->Nparametros.size());
+        if (!function->cuerpo) continue;
+        for (VarDec* vd : function->cuerpo->vdlist) total += static_cast<long>(vd->variables.size());
+        for (Stm* s : function->cuerpo->stmlist) total += declared_slots(s, types);
+    }
+    return total;
+}
+
+// =============================================================================
+// Despacho de expresiones: cadena de dynamic_cast vs switch sobre kind.
+// Ambos recorridos calculan el mismo checksum.
+// =============================================================================
+
+static long walk_rtti(Exp* e) {
+    if (NumberExp* n = dynamic_cast<NumberExp*>(e)) return 1 + (n->value & 1);
+    if (BoolExp* b = dynamic_cast<BoolExp*>(e)) return 1 + b->valor;
+    if (IdExp* id = dynamic_cast<IdExp*>(e)) return 1 + (id->sym & 1);
+    if (BinaryExp* bin = dynamic_cast<BinaryExp*>(e)) return 1 + walk_rtti(bin->left) + walk_rtti(bin->right);
+    if (ArrayAccessExp* a = dynamic_cast<ArrayAccessExp*>(e)) return 1 + walk_rtti(a->array) + walk_rtti(a->index);
+    if (FieldAccessExp* f = dynamic_cast<FieldAccessExp*>(e)) return 1 + walk_rtti(f->object);
+    if (FcallExp* c = dynamic_cast<FcallExp*>(e)) {
+        long n = 1;
+        for (auto a : c->argumentos) n += walk_rtti(a);
+        return n;
+    }
+    if (StructInitExp* s = dynamic_cast<StructInitExp*>(e)) {
+        long n = 1;
+        for (auto& f : s->fields) n += walk_rtti(f.second);
+        return n;
+    }
+    return 1;
+}
+
+static long walk_kind(Exp* e) {
+    switch (e->kind) {
+        case ExpKind::NUMBER: return 1 + (static_cast<NumberExp*>(e)->value & 1);
+        case ExpKind::BOOL: return 1 + static_cast<BoolExp*>(e)->valor;
+        case ExpKind::ID: return 1 + (static_cast<IdExp*>(e)->sym & 1);
+        case ExpKind::BINARY: {
+            BinaryExp* bin = static_cast<BinaryExp*>(e);
+            return 1 + walk_kind(bin->left) + walk_kind(bin->right);
+        }
+        case ExpKind::ARRAY_ACCESS: {
+            ArrayAccessExp* a = static_cast<ArrayAccessExp*>(e);
+            return 1 + walk_kind(a->array) + walk_kind(a->index);
+        }
+        case ExpKind::FIELD_ACCESS: return 1 + walk_kind(static_cast<FieldAccessExp*>(e)->object);
+        case ExpKind::FCALL: {
+            long n = 1;
+            for (auto a : static_cast<FcallExp*>(e)->argumentos) n += walk_kind(a);
+            return n;
+        }
+        case ExpKind::STRUCT_INIT: {
+            long n = 1;
+            for (auto& f : static_cast<StructInitExp*>(e)->fields) n += walk_kind(f.second);
+            return n;
+        }
+        case ExpKind::FLOAT: return 1;
+    }
+    return 1;
+}
+
+// =============================================================================
+// Claves del cache de CSE: firma de texto recursiva (esquema anterior de
+// GenCodeVisitor) vs el hash estructural que trae cada nodo (Exp::hash)
+// =============================================================================
+
+static string text_signature(Exp* e) {
+    switch (e->kind) {
+        case ExpKind::NUMBER: return "NUM:" + to_string(static_cast<NumberExp*>(e)->value);
+        case ExpKind::BOOL: return "BOOL:" + to_string(static_cast<BoolExp*>(e)->valor ? 1 : 0);
+        case ExpKind::ID: return "ID:" + to_string(static_cast<IdExp*>(e)->sym) + "#";
+        case ExpKind::BINARY: {
+            BinaryExp* bin = static_cast<BinaryExp*>(e);
+            if (!bin->hash) return "";
+            return "BIN:(" + text_signature(bin->left) + ")" + Exp::binopToChar(bin->op) +
+                   "(" + text_signature(bin->right) + ")";
+        }
+        default: return "";
+    }
+}
+
+// =============================================================================
+// Parseo de expresiones: cascada de un nivel por precedencia (como el parser
+// anterior) vs precedence climbing con tabla (como Parser::parseBinary).
+// Ambos recorren los inicializadores tras '=' en el buffer de tokens, cuentan
+// sus llamadas y calculan el mismo checksum de la forma del árbol.
+// =============================================================================
+
+class ExpReader {
+protected:
+    const TokenBuffer& toks;
+    size_t pos = 0;
+
+public:
+    long calls = 0;
+    long primaries = 0;
+
+    explicit ExpReader(const TokenBuffer& t) : toks(t) {}
+
+protected:
+    Token::Type cur() const { return toks.kind(pos); }
+    bool eat(Token::Type t) {
+        if (cur() != t) return false;
+        ++pos;
+        return true;
+    }
+
+    static unsigned long node(unsigned long l, unsigned long r, int op) { return l * 31 + r * 7 + op; }
+
+    virtual unsigned long expression() = 0;
+
+    unsigned long unary() {
+        ++calls;
+        if (eat(Token::NOT) || eat(Token::MINUS) || eat(Token::PLUS)) return unary();
+        return postfix();
+    }
+
+    unsigned long postfix() {
+        ++calls;
+        unsigned long h = primary();
+        while (true) {
+            if (eat(Token::DOT)) { ++pos; h = h * 3 + 1; continue; }
+            if (eat(Token::LBRACKET)) { h = node(h, expression(), 90); eat(Token::RBRACKET); continue; }
+            if (eat(Token::LPAREN)) {
+                if (cur() != Token::RPAREN) {
+                    do h = node(h, expression(), 91); while (eat(Token::COMMA));
+                }
+                eat(Token::RPAREN);
+                continue;
+            }
+            if (cur() == Token::LBRACE && toks.kind(pos - 1) == Token::IDENTIFIER) {
+                ++pos;
+                if (cur() != Token::RBRACE) {
+                    do { pos += 2; h = node(h, expression(), 92); } while (eat(Token::COMMA));
+                }
+                eat(Token::RBRACE);
+                continue;
+            }
+            break;
+        }
+        return h;
+    }
+
+    unsigned long primary() {
+        ++calls;
+        ++primaries;
+        if (eat(Token::LPAREN)) { unsigned long h = expression(); eat(Token::RPAREN); return h; }
+        ++pos; // NUMBER, IDENTIFIER, TRUE, FALSE
+        return 1;
+    }
+
+public:
+    // Parsea todas las expresiones que siguen a un '=' del buffer
+    unsigned long run() {
+        unsigned long sum = 0;
+        calls = primaries = 0;
+        for (size_t i = 0; i + 1 < toks.size(); ++i) {
+            if (toks.kind(i) != Token::ASSIGN) continue;
+            pos = i + 1;
+            sum += expression();
+        }
+        return sum;
+    }
+};
+
+class CascadeExpReader : public ExpReader {
+public:
+    using ExpReader::ExpReader;
+
+private:
+    unsigned long expression() override { ++calls; return orExp(); }
+
+    unsigned long orExp() {
+        ++calls;
+        unsigned long h = andExp();
+        while (eat(Token::OR)) h = node(h, andExp(), AND_OP);
+        return h;
+    }
+    unsigned long andExp() {
+        ++calls;
+        unsigned long h = relExp();
+        while (eat(Token::AND)) h = node(h, relExp(), AND_OP);
+        return h;
+    }
+    unsigned long relExp() {
+        ++calls;
+        unsigned long h = addExp();
+        while (true) {
+            Token::Type t = cur();
+            BinaryOp op;
+            if (t == Token::EQ) op = EQ_OP;
+            else if (t == Token::NEQ) op = NEQ_OP;
+            else if (t == Token::LT) op = LT_OP;
+            else if (t == Token::GT) op = GT_OP;
+            else if (t == Token::LE) op = LE_OP;
+            else if (t == Token::GE) op = GE_OP;
+            else break;
+            ++pos;
+            h = node(h, addExp(), op);
+        }
+        return h;
+    }
+    unsigned long addExp() {
+        ++calls;
+        unsigned long h = mulExp();
+        while (cur() == Token::PLUS || cur() == Token::MINUS) {
+            BinaryOp op = toks.kind(pos++) == Token::PLUS ? PLUS_OP : MINUS_OP;
+            h = node(h, mulExp(), op);
+        }
+        return h;
+    }
+    unsigned long mulExp() {
+        ++calls;
+        unsigned long h = unary();
+        while (cur() == Token::MUL || cur() == Token::DIV) {
+            BinaryOp op = toks.kind(pos++) == Token::MUL ? MUL_OP : DIV_OP;
+            h = node(h, unary(), op);
+        }
+        return h;
+    }
+};
+
+class ClimbingExpReader : public ExpReader {
+public:
+    explicit ClimbingExpReader(const TokenBuffer& t) : ExpReader(t), prec(), ops() {
+        set(Token::OR, 1, AND_OP);
+        set(Token::AND, 2, AND_OP);
+        set(Token::EQ, 3, EQ_OP);
+        set(Token::NEQ, 3, NEQ_OP);
+        set(Token::LT, 3, LT_OP);
+        set(Token::GT, 3, GT_OP);
+        set(Token::LE, 3, LE_OP);
+        set(Token::GE, 3, GE_OP);
+        set(Token::PLUS, 4, PLUS_OP);
+        set(Token::MINUS, 4, MINUS_OP);
+        set(Token::MUL, 5, MUL_OP);
+        set(Token::DIV, 5, DIV_OP);
+    }
+
+private:
+    uint8_t prec[Token::AND_LEGACY + 1];
+    BinaryOp ops[Token::AND_LEGACY + 1];
+
+    void set(Token::Type t, uint8_t p, BinaryOp op) { prec[t] = p; ops[t] = op; }
+
+    unsigned long expression() override { ++calls; return binary(1); }
+
+    unsigned long binary(int minPrec) {
+        ++calls;
+        unsigned long h = unary();
+        while (true) {
+            Token::Type t = cur();
+            if (prec[t] < minPrec) break;
+            ++pos;
+            h = node(h, binary(prec[t] + 1), ops[t]);
+        }
+        return h;
+    }
+};
+
+// =============================================================================
+// Medición
+// =============================================================================
+
+static double seconds_since(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Ejecuta fn repetidamente (mínimo minReps veces y ~minTime segundos) y
+// retorna el mejor tiempo
+template <typename F>
+static double best_time(F fn, int minReps = 3, double minTime = 0.3) {
+    double best = 1e30, total = 0;
+    for (int rep = 0; rep < minReps || total < minTime; ++rep) {
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        double dt = seconds_since(t0);
+        total += dt;
+        if (dt < best) best = dt;
+        if (rep >= 50) break;
+    }
+    return best;
+}
+
+static void usage(const char* prog) {
+    cerr << "Uso: " << prog << " [--lines N] [--depth D] [--structs S] [--stmts K] [--chain C] [--threads T] [--seed X]"
+         << " [--emit archivo] [--input archivo]\n";
+}
+
+int main(int argc, char* argv[]) {
+    GenConfig cfg;
+    string emitPath, inputPath;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(argv[0]); exit(1); }
+            return argv[++i];
+        };
+        if (arg == "--lines") cfg.lines = atol(value());
+        else if (arg == "--depth") cfg.depth = atoi(value());
+        else if (arg == "--structs") cfg.structs = atoi(value());
+        else if (arg == "--stmts") cfg.stmtsPerFn = atoi(value());
+        else if (arg == "--chain") cfg.chain = atoi(value());
+        else if (arg == "--threads") cfg.threads = static_cast<unsigned>(atol(value()));
+        else if (arg == "--seed") cfg.seed = static_cast<unsigned>(atol(value()));
+        else if (arg == "--emit") emitPath = value();
+        else if (arg == "--input") inputPath = value();
+        else { usage(argv[0]); return 1; }
+    }
+
+    string source;
+    long lines = 0;
+    if (!inputPath.empty()) {
+        ifstream in(inputPath, ios::binary);
+        if (!in.is_open()) { cerr << "No se pudo abrir " << inputPath << endl; return 1; }
+        stringstream ss;
+        ss << in.rdbuf();
+        source = ss.str();
+        for (char c : source) lines += (c == '\n');
+    } else {
+        ProgramGenerator gen(cfg);
+        source = gen.generate();
+        lines = gen.lines();
+    }
+
+    if (!emitPath.empty()) {
+        ofstream out(emitPath, ios::binary);
+        out << source;
+        return 0;
+    }
+
+    // Scanner: lexeo completo al buffer contiguo
+    TokenBuffer tokens;
+    double scanTime = best_time([&]() {
+        Scanner scanner(source.data(), source.size());
+        scanner.tokenize(tokens);
+    });
+    if (tokens.kind(tokens.size() - 1) == Token::ERR) {
+        cerr << "Error léxico en la entrada del benchmark" << endl;
+        return 1;
+    }
+
+    // Parser sobre el buffer (se silencia el "Parseo exitoso" del parser)
+    long astNodes = 0;
+    size_t arenaBytes = 0;
+    streambuf* saved = cout.rdbuf();
+    ostringstream sink;
+    cout.rdbuf(sink.rdbuf());
+    double parseTime;
+    try {
+        parseTime = best_time([&]() {
+            Parser parser(&tokens);
+            Program* program = parser.parseProgram();
+            NodeCounter counter;
+            program->accept(&counter);
+            astNodes = counter.nodes;
+            arenaBytes = program->arena.bytesUsed();
+            delete program;
+        });
+    } catch (const exception& e) {
+        cout.rdbuf(saved);
+        cerr << "Error de parseo en la entrada del benchmark: " << e.what() << endl;
+        return 1;
+    }
+
+    // Sólo firmas: cuerpos saltados por llaves; luego se construyen todos
+    // para comprobar que el árbol diferido es el mismo
+    double signaturesTime = best_time([&]() {
+        Parser parser(&tokens);
+        parser.setLazyBodies(true);
+        delete parser.parseProgram();
+    });
+    {
+        Parser parser(&tokens);
+        parser.setLazyBodies(true);
+        Program* program = parser.parseProgram();
+        parser.parseAllBodies(program);
+        NodeCounter counter;
+        program->accept(&counter);
+        delete program;
+        if (counter.nodes != astNodes) {
+            cout.rdbuf(saved);
+            cerr << "El parseo diferido no reproduce el AST" << endl;
+            return 1;
+        }
+    }
+
+    // Cuerpos de funciones en paralelo; mismo árbol que el parseo secuencial
+    long parallelNodes = 0;
+    double parallelTime = best_time([&]() {
+        Parser parser(&tokens);
+        Program* program = parser.parseProgramParallel(cfg.threads);
+        NodeCounter counter;
+        program->accept(&counter);
+        parallelNodes = counter.nodes;
+        delete program;
+    });
+    if (parallelNodes != astNodes) {
+        cout.rdbuf(saved);
+        cerr << "El parseo paralelo no reproduce el AST" << endl;
+        return 1;
+    }
+
+    // Análisis semántico completo (slots y tipos) y recorrido de ambas
+    // representaciones con la misma cuenta de slots declarados
+    Parser parser(&tokens);
+    Program* program = parser.parseProgram();
+    cout.rdbuf(saved);
+    FlatAst flat;
+    double flattenTime = best_time([&]() { flat = FlatAst::fromProgram(program); });
+    TypeCheckerVisitor checker;
+    double typesTime = best_time([&]() { checker.analyze(program); });
+    TypeTable frameTypes = checker.typeTable();
+    long pointerSlots = 0, flatSlots = 0;
+    double pointerWalk = best_time([&]() { pointerSlots = declared_frame_slots(program, frameTypes); });
+    double flatWalk = best_time([&]() { flatSlots = declared_frame_slots(flat, frameTypes); });
+    if (pointerSlots != flatSlots) {
+        cerr << "Los recorridos del AST plano y de punteros no coinciden" << endl;
+        return 1;
+    }
+
+    // Frames: pico por función (como el prólogo, múltiplo de 16 bytes) contra
+    // sumar todas las declaraciones más los 10 slots fijos de antes
+    long frameBytes = 0, declaredFrameBytes = 0;
+    for (auto& function : flat.functions) {
+        long declared = static_cast<long>(function.Nparametros.size());
+        for (auto& vd : function.vdlist) declared += static_cast<long>(vd.variables.size());
+        for (FlatAst::Index k = 0; k < function.bodyCount; k++) {
+            declared += declared_slots(flat, frameTypes, flat.lists[function.bodyStart + k]);
+        }
+        declaredFrameBytes += (declared + 10) * 8;
+        frameBytes += (checker.frameSlots[function.nombre] * 8 + 15) / 16 * 16;
+    }
+
+    // Layout de structs: bytes y padding en orden declarado y reordenado
+    uint64_t structBytes[2] = {0, 0}, structPadding[2] = {0, 0};
+    for (int reorder = 0; reorder < 2; reorder++) {
+        TypeTable layoutTypes;
+        layoutTypes.setFieldReordering(reorder != 0);
+        for (auto& alias : flat.aliases) layoutTypes.addAlias(alias.alias, alias.type);
+        for (auto& sd : flat.structs) layoutTypes.declareStruct(sd.name, sd.fields);
+        layoutTypes.layoutStructs();
+        for (auto& sd : flat.structs) {
+            const TypeDesc& desc = layoutTypes.get(layoutTypes.intern(sd.name));
+            structBytes[reorder] += desc.size;
+            structPadding[reorder] += desc.padding;
+        }
+    }
+    ostringstream blob;
+    flat.write(blob);
+    size_t serializedBytes = blob.str().size();
+
+    // Cache en disco: leer el AST de un fuente ya visto vs lexear y parsear
+    AstCache cache((filesystem::temp_directory_path() / "benchmark_ast_cache").string());
+    if (!cache.store(source.data(), source.size(), flat)) {
+        cerr << "No se pudo escribir el cache de AST" << endl;
+        return 1;
+    }
+    bool cacheHit = true;
+    double cacheLoadTime = best_time([&]() {
+        FlatAst loaded;
+        cacheHit = cacheHit && cache.load(source.data(), source.size(), loaded);
+        delete loaded.materialize();
+    });
+    if (!cacheHit) {
+        cerr << "El cache de AST no encontró la entrada recién guardada" << endl;
+        return 1;
+    }
+
+    // Despacho sobre todos los árboles de expresión del programa
+    ExpRootCollector collector;
+    program->accept(&collector);
+    long rttiSum = 0, kindSum = 0;
+    double rttiTime = best_time([&]() {
+        rttiSum = 0;
+        for (Exp* e : collector.roots) rttiSum += walk_rtti(e);
+    });
+    double kindTime = best_time([&]() {
+        kindSum = 0;
+        for (Exp* e : collector.roots) kindSum += walk_kind(e);
+    });
+    if (rttiSum != kindSum) {
+        cerr << "Los recorridos de despacho no coinciden" << endl;
+        return 1;
+    }
+
+    // CSE: una clave por cada subexpresión binaria apta de cada raíz
+    vector<Exp*> cseNodes;
+    for (Exp* root : collector.roots) {
+        vector<Exp*> stack = {root};
+        while (!stack.empty()) {
+            BinaryExp* bin = as<BinaryExp>(stack.back());
+            stack.pop_back();
+            if (!bin) continue;
+            if (bin->hash) cseNodes.push_back(bin);
+            stack.push_back(bin->left);
+            stack.push_back(bin->right);
+        }
+    }
+    size_t textKeys = 0, hashKeys = 0;
+    double textKeyTime = best_time([&]() {
+        unordered_set<string> keys;
+        for (Exp* e : cseNodes) keys.insert(text_signature(e));
+        textKeys = keys.size();
+    });
+    double hashKeyTime = best_time([&]() {
+        unordered_set<uint64_t> keys;
+        for (Exp* e : cseNodes) keys.insert(e->hash);
+        hashKeys = keys.size();
+    });
+    if (textKeys != hashKeys) {
+        cerr << "Las claves de CSE no coinciden" << endl;
+        return 1;
+    }
+    // Tabla de símbolos: misma traza de scopes sobre ambas tablas
+    ScopeTrace trace;
+    program->accept(&trace);
+    long mapScopeSum = 0, flatScopeSum = 0;
+    double mapScopeTime = best_time([&]() {
+        MapPerScopeEnv env;
+        mapScopeSum = replay_scopes(trace, env);
+    });
+    double flatScopeTime = best_time([&]() {
+        Environment<SymbolInfo, SymbolId> env;
+        flatScopeSum = replay_scopes(trace, env);
+    });
+    if (mapScopeSum != flatScopeSum) {
+        cerr << "Las tablas de símbolos no coinciden" << endl;
+        return 1;
+    }
+
+    delete program;
+
+    // Hash-consing: subárboles puros compartidos y memoria de la arena
+    size_t sharedExps = 0, consedArenaBytes = 0;
+    cout.rdbuf(sink.rdbuf());
+    double consTime = best_time([&]() {
+        Parser consParser(&tokens);
+        consParser.setHashConsing(true);
+        Program* consed = consParser.parseProgram();
+        sharedExps = consParser.sharedExpressions();
+        consedArenaBytes = consed->arena.bytesUsed();
+        delete consed;
+    });
+    cout.rdbuf(saved);
+
+    // Reparseo incremental: editar un literal de una función del medio y
+    // deshacer la edición, contra lexear y parsear todo el fuente editado
+    size_t literal = source.find("\nfn ", source.size() / 2);
+    literal = literal == string::npos ? string::npos : source.find('{', literal);
+    while (literal < source.size() &&
+           !(isdigit(static_cast<unsigned char>(source[literal])) && !isalnum(static_cast<unsigned char>(source[literal - 1])) &&
+             source[literal - 1] != '_')) {
+        literal++;
+    }
+    double incrementalTime = 0, editFullTime = 0;
+    size_t relexedTokens = 0;
+    bool incrementalOk = literal < source.size();
+    if (incrementalOk) {
+        string edited = source;
+        edited.replace(literal, 1, "7777");
+        uint32_t at = static_cast<uint32_t>(literal);
+        SourceEdit forward = {at, at + 1, at + 4};
+        SourceEdit backward = {at, at + 4, at + 1};
+
+        TokenBuffer liveTokens;
+        Scanner(source.data(), source.size()).tokenize(liveTokens);
+        cout.rdbuf(sink.rdbuf());
+        Program* live = Parser(&liveTokens).parseProgram();
+        ReparseResult edit = reparseEdit(edited.data(), edited.size(), forward, liveTokens, live);
+        relexedTokens = edit.relexedTokens;
+
+        // El árbol incremental debe ser idéntico al de un parseo completo
+        TokenBuffer fullTokens;
+        Scanner(edited.data(), edited.size()).tokenize(fullTokens);
+        Program* full = Parser(&fullTokens).parseProgram();
+        ostringstream a, b;
+        FlatAst::fromProgram(live).write(a);
+        FlatAst::fromProgram(full).write(b);
+        incrementalOk = edit.incremental && a.str() == b.str();
+        delete full;
+
+        // Cada repetición aplica la edición y la deshace (dos reparseos)
+        incrementalTime = best_time([&]() {
+            reparseEdit(source.data(), source.size(), backward, liveTokens, live);
+            reparseEdit(edited.data(), edited.size(), forward, liveTokens, live);
+        }) / 2;
+        editFullTime = best_time([&]() {
+            TokenBuffer t;
+            Scanner(edited.data(), edited.size()).tokenize(t);
+            delete Parser(&t).parseProgram();
+        });
+        cout.rdbuf(saved);
+        delete live;
+    }
+    if (!incrementalOk) {
+        cerr << "El reparseo incremental no reproduce el AST del parseo completo" << endl;
+        return 1;
+    }
+
+    // Expresiones: llamadas por primaria y tiempo de ambos esquemas
+    CascadeExpReader cascade(tokens);
+    ClimbingExpReader climbing(tokens);
+    unsigned long cascadeSum = 0, climbingSum = 0;
+    double cascadeTime = best_time([&]() { cascadeSum = cascade.run(); });
+    double climbingTime = best_time([&]() { climbingSum = climbing.run(); });
+    if (cascadeSum != climbingSum) {
+        cerr << "Los parsers de expresiones no coinciden" << endl;
+        return 1;
+    }
+    auto perPrimary = [](const ExpReader& r) { return r.primaries ? double(r.calls) / r.primaries : 0.0; };
+
+    double mb = source.size() / 1e6;
+    auto num = [](double v, int decimals) {
+        ostringstream os;
+        os.setf(ios::fixed);
+        os.precision(decimals);
+        os << v;
+        return os.str();
+    };
+    cout << "{\n";
+    cout << "  \"schema_version\": " << kSchemaVersion << ",\n";
+    cout << "  \"input\": {\"lines\": " << lines << ", \"bytes\": " << source.size()
+         << ", \"tokens\": " << tokens.size() << ", \"ast_nodes\": " << astNodes
+         << ", \"depth\": " << cfg.depth << ", \"chain\": " << cfg.chain << ", \"seed\": " << cfg.seed << "},\n";
+    cout << "  \"scanner\": {\"seconds\": " << num(scanTime, 6)
+         << ", \"tokens_per_sec\": " << num(tokens.size() / scanTime, 0)
+         << ", \"mb_per_sec\": " << num(mb / scanTime, 2) << "},\n";
+    cout << "  \"parser\": {\"seconds\": " << num(parseTime, 6)
+         << ", \"tokens_per_sec\": " << num(tokens.size() / parseTime, 0)
+         << ", \"ast_nodes_per_sec\": " << num(astNodes / parseTime, 0)
+         << ", \"arena_bytes\": " << arenaBytes << "},\n";
+    cout << "  \"hash_consing\": {\"seconds\": " << num(consTime, 6)
+         << ", \"shared_expressions\": " << sharedExps
+         << ", \"arena_bytes\": " << consedArenaBytes << "},\n";
+    cout << "  \"signatures\": {\"seconds\": " << num(signaturesTime, 6)
+         << ", \"tokens_per_sec\": " << num(tokens.size() / signaturesTime, 0)
+         << ", \"vs_scanner\": " << num(signaturesTime / scanTime, 2)
+         << ", \"vs_full_parse\": " << num(signaturesTime / parseTime, 2) << "},\n";
+    cout << "  \"parallel_parse\": {\"threads\": " << cfg.threads
+         << ", \"seconds\": " << num(parallelTime, 6)
+         << ", \"speedup\": " << num(parseTime / parallelTime, 2) << "},\n";
+    cout << "  \"traversal\": {\"pointer_seconds\": " << num(pointerWalk, 6)
+         << ", \"flat_seconds\": " << num(flatWalk, 6)
+         << ", \"speedup\": " << num(pointerWalk / flatWalk, 2)
+         << ", \"flatten_seconds\": " << num(flattenTime, 6)
+         << ", \"flat_bytes\": " << flat.bytes()
+         << ", \"serialized_bytes\": " << serializedBytes << "},\n";
+    cout << "  \"types\": {\"annotate_seconds\": " << num(typesTime, 6)
+         << ", \"vs_full_parse\": " << num(typesTime / parseTime, 2) << "},\n";
+    cout << "  \"frames\": {\"functions\": " << flat.functions.size()
+         << ", \"bytes\": " << frameBytes
+         << ", \"previous_bytes\": " << declaredFrameBytes
+         << ", \"reduction\": " << num(double(declaredFrameBytes) / frameBytes, 2) << "},\n";
+    cout << "  \"struct_layout\": {\"structs\": " << flat.structs.size()
+         << ", \"bytes\": " << structBytes[0] << ", \"padding\": " << structPadding[0]
+         << ", \"reordered_bytes\": " << structBytes[1]
+         << ", \"reordered_padding\": " << structPadding[1] << "},\n";
+    cout << "  \"ast_cache\": {\"load_seconds\": " << num(cacheLoadTime, 6)
+         << ", \"scan_parse_seconds\": " << num(scanTime + parseTime, 6)
+         << ", \"speedup\": " << num((scanTime + parseTime) / cacheLoadTime, 2) << "},\n";
+    cout << "  \"incremental\": {\"relexed_tokens\": " << relexedTokens
+         << ", \"seconds\": " << num(incrementalTime, 6)
+         << ", \"full_seconds\": " << num(editFullTime, 6)
+         << ", \"speedup\": " << num(editFullTime / incrementalTime, 2) << "},\n";
+    cout << "  \"symbols\": {\"operations\": " << trace.ops.size()
+         << ", \"map_per_scope_seconds\": " << num(mapScopeTime, 6)
+         << ", \"flat_seconds\": " << num(flatScopeTime, 6)
+         << ", \"speedup\": " << num(mapScopeTime / flatScopeTime, 2) << "},\n";
+    cout << "  \"dispatch\": {\"expression_roots\": " << collector.roots.size()
+         << ", \"rtti_seconds\": " << num(rttiTime, 6)
+         << ", \"kind_seconds\": " << num(kindTime, 6)
+         << ", \"speedup\": " << num(rttiTime / kindTime, 2) << "},\n";
+    cout << "  \"cse_keys\": {\"subexpressions\": " << cseNodes.size()
+         << ", \"distinct\": " << hashKeys
+         << ", \"text_seconds\": " << num(textKeyTime, 6)
+         << ", \"hash_seconds\": " << num(hashKeyTime, 6)
+         << ", \"speedup\": " << num(textKeyTime / hashKeyTime, 2) << "},\n";
+    cout << "  \"expressions\": {\"primaries\": " << climbing.primaries
+         << ", \"cascade_calls_per_primary\": " << num(perPrimary(cascade), 2)
+         << ", \"climbing_calls_per_primary\": " << num(perPrimary(climbing), 2)
+         << ", \"cascade_seconds\": " << num(cascadeTime, 6)
+         << ", \"climbing_seconds\": " << num(climbingTime, 6)
+         << ", \"speedup\": " << num(cascadeTime / climbingTime, 2) << "}\n";
+    cout << "}" << endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+import json
+import os
+import subprocess
+import sys
+
+# Compila el benchmark de Scanner/Parser y lo ejecuta sobre programas
+# sintéticos de distintos tamaños. Imprime un único JSON con todos los
+# resultados (o lo guarda con --out archivo).
+#
+# Uso: python3 benchmarks/run_benchmarks.py [--sizes 1000,10000,...] [--depth D] [--chain C] [--out archivo]
+
+here = os.path.dirname(os.path.abspath(__file__))
+root = os.path.dirname(here)
+
+# Archivos c++ (todo el compilador menos main.cpp)
+programa = [
+    "source_buffer.cpp",
+    "interner.cpp",
+    "arena.cpp",
+    "flat_ast.cpp",
+    "line_table.cpp",
+    "scanner.cpp",
+    "token.cpp",
+    "parser.cpp",
+    "ast.cpp",
+    "visitor.cpp",
+    "optimizer.cpp",
+    "ast_cache.cpp",
+    "incremental.cpp",
+    "type_table.cpp",
+    "const_eval.cpp"
+]
+
+sizes = [1000, 10000, 100000, 1000000]
+depth = 4
+chain = 0
+out_file = None
+
+args = sys.argv[1:]
+i = 0
+while i < len(args):
+    if args[i] == "--sizes":
+        sizes = [int(x) for x in args[i + 1].split(",")]
+        i += 2
+    elif args[i] == "--depth":
+        depth = int(args[i + 1])
+        i += 2
+    elif args[i] == "--chain":
+        chain = int(args[i + 1])
+        i += 2
+    elif args[i] == "--out":
+        out_file = args[i + 1]
+        i += 2
+    else:
+        print("Argumento desconocido:", args[i], file=sys.stderr)
+        exit(1)
+
+binary = os.path.join(here, "benchmark.exe" if os.name == "nt" else "benchmark")
+
+compile = ["g++", "-std=c++17", "-O2", "-pthread", "-o", binary, os.path.join(here, "benchmark.cpp")]
+compile += [os.path.join(root, f) for f in programa]
+print("Compilando:", " ".join(compile), file=sys.stderr)
+result = subprocess.run(compile, capture_output=True, text=True)
+
+if result.returncode != 0:
+    print("Error en compilación:\n", result.stderr, file=sys.stderr)
+    exit(1)
+
+runs = []
+for lines in sizes:
+    print(f"Ejecutando benchmark con {lines} líneas", file=sys.stderr)
+    run_cmd = [binary, "--lines", str(lines), "--depth", str(depth), "--chain", str(chain)]
+    result = subprocess.run(run_cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        print("Error en benchmark:\n", result.stderr, file=sys.stderr)
+        exit(1)
+    runs.append(json.loads(result.stdout))
+
+report = json.dumps({"schema_version": runs[0]["schema_version"] if runs else 2, "runs": runs}, indent=2)
+if out_file:
+    with open(out_file, "w") as f:
+        f.write(report + "\n")
+else:
+    print(report)
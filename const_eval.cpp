@@ -0,0 +1,498 @@
+#include "const_eval.h"
+#include <climits>
+
+using namespace std;
+
+// Topes de una evaluación (un const item o una llamada plegada)
+static const size_t kMaxSteps = 10000000;
+static const int kMaxDepth = 256;
+
+namespace {
+
+// Motivo por el que una const fn no es evaluable ("" si lo es)
+string nonConstExp(Exp* e, const unordered_map<SymbolId, FunDec*>& constFns) {
+    if (!e) return "";
+    switch (e->kind) {
+        case ExpKind::NUMBER:
+        case ExpKind::BOOL:
+        case ExpKind::ID:
+            return "";
+        case ExpKind::BINARY: {
+            BinaryExp* b = static_cast<BinaryExp*>(e);
+            if (b->op == ASSIGN_OP && !as<IdExp>(b->left)) return "sólo puede asignar variables locales";
+            string why = nonConstExp(b->left, constFns);
+            return why.empty() ? nonConstExp(b->right, constFns) : why;
+        }
+        case ExpKind::FCALL: {
+            FcallExp* f = static_cast<FcallExp*>(e);
+            if (!constFns.count(f->sym)) return "llama a " + f->nombre() + ", que no es const fn";
+            for (Exp* a : f->argumentos) {
+                string why = nonConstExp(a, constFns);
+                if (!why.empty()) return why;
+            }
+            return "";
+        }
+        default:
+            return "sólo admite enteros y bool";
+    }
+}
+
+string nonConstStm(Stm* s, const unordered_map<SymbolId, FunDec*>& constFns) {
+    if (!s) return "";
+    string why;
+    switch (s->kind) {
+        case StmKind::BLOCK:
+            for (Stm* st : static_cast<BlockStm*>(s)->statements) {
+                why = nonConstStm(st, constFns);
+                if (!why.empty()) break;
+            }
+            return why;
+        case StmKind::LET:
+            return nonConstExp(static_cast<LetStm*>(s)->init, constFns);
+        case StmKind::IF: {
+            IfStm* i = static_cast<IfStm*>(s);
+            why = nonConstExp(i->condition, constFns);
+            if (why.empty()) why = nonConstStm(i->thenBlock, constFns);
+            return why.empty() ? nonConstStm(i->elseBlock, constFns) : why;
+        }
+        case StmKind::WHILE: {
+            WhileStm* w = static_cast<WhileStm*>(s);
+            why = nonConstExp(w->condition, constFns);
+            return why.empty() ? nonConstStm(w->body, constFns) : why;
+        }
+        case StmKind::FOR: {
+            ForStm* f = static_cast<ForStm*>(s);
+            why = nonConstExp(f->start, constFns);
+            if (why.empty()) why = nonConstExp(f->end, constFns);
+            return why.empty() ? nonConstStm(f->body, constFns) : why;
+        }
+        case StmKind::PRINT:
+            return "no puede usar println!";
+        case StmKind::ASSIGN:
+            return nonConstExp(static_cast<AssignStm*>(s)->e, constFns);
+        case StmKind::RETURN:
+            return nonConstExp(static_cast<ReturnStm*>(s)->e, constFns);
+    }
+    return why;
+}
+
+} // namespace
+
+ConstEvaluator::ConstEvaluator(Program* p, TypeTable& t) : program(p), types(t) {}
+
+// -----------------------------
+// Const items
+// -----------------------------
+
+void ConstEvaluator::evaluateAll() {
+    constants.clear();
+    constFunctions.clear();
+    for (FunDec* fd : program->fdlist) {
+        if (fd && fd->isConst) constFunctions[global_interner().intern(fd->nombre)] = fd;
+    }
+    for (ConstDec* cd : program->cdlist) {
+        if (constants.count(cd->sym)) {
+            throw runtime_error("Error semántico: constante " + cd->name() + " redefinida");
+        }
+        TypeId type = types.intern(cd->tipo);
+        const TypeDesc& desc = types.get(type);
+        bool integral = desc.kind == TypeDesc::SCALAR &&
+                        (desc.scalar == Type::I32 || desc.scalar == Type::I64 || desc.scalar == Type::U32 ||
+                         desc.scalar == Type::U64 || desc.scalar == Type::BOOL);
+        if (!integral) {
+            throw runtime_error("Error semántico: la constante " + cd->name() + " debe ser entera o bool");
+        }
+        constants[cd->sym] = Constant{cd, type, 0, kPending};
+    }
+
+    for (FunDec* fd : program->fdlist) {
+        if (fd && fd->isConst) validate(fd);
+    }
+    for (ConstDec* cd : program->cdlist) {
+        steps = 0;
+        depth = 0;
+        try {
+            types.defineConstant(cd->name(), value(cd->sym));
+        } catch (const ConstError& e) {
+            throw runtime_error("Error semántico: la constante " + cd->name() +
+                                " no se puede evaluar en compilación: " + e.what());
+        }
+    }
+}
+
+int64_t ConstEvaluator::value(SymbolId name) {
+    auto it = constants.find(name);
+    if (it == constants.end()) throw ConstError(global_interner().name(name) + " no es una constante");
+    Constant& c = it->second;
+    if (c.state == kDone) return c.value;
+    if (c.state == kInProgress) {
+        throw runtime_error("Error semántico: la constante " + c.decl->name() + " depende de sí misma");
+    }
+    c.state = kInProgress;
+    int64_t v = narrow(eval(c.decl->init, nullptr), c.type);
+    c.value = v;
+    c.state = kDone;
+    return v;
+}
+
+void ConstEvaluator::validate(FunDec* fd) {
+    if (!fd->cuerpo) return;
+    for (Stm* s : fd->cuerpo->stmlist) {
+        string why = nonConstStm(s, constFunctions);
+        if (!why.empty()) throw runtime_error("Error semántico: const fn " + fd->nombre + " " + why);
+    }
+}
+
+// -----------------------------
+// Intérprete
+// -----------------------------
+
+// Una variable de 4 bytes guarda sólo los 32 bits bajos y se lee con movl
+int64_t ConstEvaluator::narrow(int64_t v, TypeId type) const {
+    return types.frameSize(type) == 4 ? static_cast<int64_t>(static_cast<uint32_t>(v)) : v;
+}
+
+void ConstEvaluator::step() {
+    if (++steps > kMaxSteps) {
+        throw ConstError("la evaluación excede " + to_string(kMaxSteps) + " pasos");
+    }
+}
+
+int64_t ConstEvaluator::eval(Exp* e, Locals* locals) {
+    step();
+    if (!e) throw ConstError("expresión vacía");
+    switch (e->kind) {
+        case ExpKind::NUMBER:
+            return static_cast<NumberExp*>(e)->value;
+        case ExpKind::BOOL:
+            return static_cast<BoolExp*>(e)->valor;
+        case ExpKind::ID: {
+            IdExp* id = static_cast<IdExp*>(e);
+            if (locals) {
+                if (Local* l = locals->lookup(id->sym)) return l->value;
+            }
+            return value(id->sym);
+        }
+        case ExpKind::BINARY:
+            return binary(static_cast<BinaryExp*>(e), locals);
+        case ExpKind::FCALL: {
+            FcallExp* f = static_cast<FcallExp*>(e);
+            vector<int64_t> args;
+            args.reserve(f->argumentos.size());
+            for (Exp* a : f->argumentos) args.push_back(eval(a, locals));
+            return call(f->sym, args);
+        }
+        default:
+            throw ConstError("expresión no evaluable en compilación");
+    }
+}
+
+int64_t ConstEvaluator::binary(BinaryExp* e, Locals* locals) {
+    if (e->op == ASSIGN_OP) {
+        IdExp* id = as<IdExp>(e->left);
+        if (!id || !locals || !locals->lookup(id->sym)) throw ConstError("asignación fuera de una variable local");
+        int64_t v = eval(e->right, locals);
+        Local* l = locals->lookup(id->sym);
+        l->value = narrow(v, l->type);
+        return v;
+    }
+    if (e->op == AND_OP) {
+        if (eval(e->left, locals) == 0) return 0;
+        return eval(e->right, locals) != 0 ? 1 : 0;
+    }
+
+    int64_t a = eval(e->left, locals);
+    int64_t b = eval(e->right, locals);
+    // + - * envuelven en 64 bits como addq/subq/imulq
+    uint64_t ua = static_cast<uint64_t>(a), ub = static_cast<uint64_t>(b);
+    switch (e->op) {
+        case PLUS_OP:  return static_cast<int64_t>(ua + ub);
+        case MINUS_OP: return static_cast<int64_t>(ua - ub);
+        case MUL_OP:   return static_cast<int64_t>(ua * ub);
+        case DIV_OP:
+            if (b == 0) throw ConstError("división por cero");
+            if (a == LLONG_MIN && b == -1) throw ConstError("desborde en división");
+            return a / b;
+        case LT_OP:  return a < b;
+        case GT_OP:  return a > b;
+        case LE_OP:  return a <= b;
+        case GE_OP:  return a >= b;
+        case EQ_OP:  return a == b;
+        case NEQ_OP: return a != b;
+        default:
+            throw ConstError("operador " + Exp::binopToChar(e->op) + " no soportado");
+    }
+}
+
+int64_t ConstEvaluator::call(SymbolId name, const vector<int64_t>& args) {
+    auto it = constFunctions.find(name);
+    if (it == constFunctions.end()) throw ConstError(global_interner().name(name) + " no es const fn");
+    FunDec* fd = it->second;
+    if (!fd->cuerpo) throw ConstError("cuerpo de " + fd->nombre + " no disponible");
+    if (args.size() != fd->Nparametros.size()) throw ConstError("cantidad de argumentos de " + fd->nombre);
+    if (depth >= kMaxDepth) throw ConstError("recursión demasiado profunda en " + fd->nombre);
+
+    Locals locals;
+    locals.push_scope();
+    for (size_t i = 0; i < args.size(); i++) {
+        TypeId type = types.intern(fd->Tparametros[i]);
+        locals.declare(fd->Nparametros[i], Local{narrow(args[i], type), type});
+    }
+    for (VarDec* vd : fd->cuerpo->vdlist) {
+        TypeId type = types.intern(vd->tipo);
+        for (const string& var : vd->variables) locals.declare(global_interner().intern(var), Local{0, type});
+    }
+
+    // Sin return explícito la función deja 0, como el epílogo generado
+    int64_t result = 0;
+    depth++;
+    try {
+        for (Stm* s : fd->cuerpo->stmlist) {
+            if (exec(s, locals, result)) break;
+        }
+    } catch (...) {
+        depth--;
+        throw;
+    }
+    depth--;
+    return result;
+}
+
+// Ejecuta una sentencia; true si ejecutó un return (valor en result)
+bool ConstEvaluator::exec(Stm* s, Locals& locals, int64_t& result) {
+    step();
+    if (!s) return false;
+    switch (s->kind) {
+        case StmKind::BLOCK: {
+            locals.push_scope();
+            for (Stm* st : static_cast<BlockStm*>(s)->statements) {
+                if (exec(st, locals, result)) {
+                    locals.pop_scope();
+                    return true;
+                }
+            }
+            locals.pop_scope();
+            return false;
+        }
+        case StmKind::LET: {
+            LetStm* let = static_cast<LetStm*>(s);
+            TypeId type = types.intern(let->type_name);
+            const TypeDesc& desc = types.get(type);
+            if (desc.kind != TypeDesc::SCALAR || desc.scalar == Type::F32 || desc.scalar == Type::F64) {
+                throw ConstError("variable " + let->name() + " no escalar entera");
+            }
+            int64_t v = let->init ? eval(let->init, &locals) : 0;
+            locals.declare(let->sym, Local{narrow(v, type), type});
+            return false;
+        }
+        case StmKind::IF: {
+            IfStm* i = static_cast<IfStm*>(s);
+            if (eval(i->condition, &locals) != 0) return exec(i->thenBlock, locals, result);
+            return exec(i->elseBlock, locals, result);
+        }
+        case StmKind::WHILE: {
+            WhileStm* w = static_cast<WhileStm*>(s);
+            while (eval(w->condition, &locals) != 0) {
+                if (exec(w->body, locals, result)) return true;
+            }
+            return false;
+        }
+        case StmKind::FOR: {
+            // Como el generador: el límite se reevalúa en cada vuelta y el
+            // iterador (i64) se incrementa desde su slot
+            ForStm* f = static_cast<ForStm*>(s);
+            locals.push_scope();
+            int64_t start = f->start ? eval(f->start, &locals) : 0;
+            locals.declare(f->iterator, Local{start, types.intern("i64")});
+            bool returned = false;
+            while (true) {
+                int64_t end = f->end ? eval(f->end, &locals) : 0;
+                if (locals.lookup(f->iterator)->value >= end) break;
+                if (exec(f->body, locals, result)) {
+                    returned = true;
+                    break;
+                }
+                Local* it = locals.lookup(f->iterator);
+                it->value = static_cast<int64_t>(static_cast<uint64_t>(it->value) + 1);
+            }
+            locals.pop_scope();
+            return returned;
+        }
+        case StmKind::PRINT:
+            throw ConstError("println! no es evaluable en compilación");
+        case StmKind::ASSIGN: {
+            AssignStm* a = static_cast<AssignStm*>(s);
+            int64_t v = a->e ? eval(a->e, &locals) : 0;
+            if (a->id() != "_") {
+                Local* l = locals.lookup(a->sym);
+                if (!l) throw ConstError("asignación fuera de una variable local");
+                l->value = narrow(v, l->type);
+            }
+            return false;
+        }
+        case StmKind::RETURN: {
+            ReturnStm* r = static_cast<ReturnStm*>(s);
+            result = r->e ? eval(r->e, &locals) : 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// -----------------------------
+// Plegado
+// -----------------------------
+
+size_t ConstEvaluator::fold(unordered_map<const Exp*, int64_t>& into) {
+    values = &into;
+    values->clear();
+    shared.clear();
+    calls.clear();
+    for (FunDec* fd : program->fdlist) {
+        if (!fd || !fd->cuerpo) continue;
+        for (SymbolId param : fd->Nparametros) checkNotConstant(param);
+        for (VarDec* vd : fd->cuerpo->vdlist) {
+            for (const string& var : vd->variables) checkNotConstant(global_interner().intern(var));
+        }
+        for (Stm* s : fd->cuerpo->stmlist) foldStm(s);
+    }
+    values = nullptr;
+    return into.size();
+}
+
+// Como en Rust, un nombre local no puede ocultar una constante ni asignarla
+void ConstEvaluator::checkNotConstant(SymbolId name) const {
+    if (isConstant(name)) {
+        throw runtime_error("Error semántico: " + global_interner().name(name) +
+                            " es una constante; no puede redeclararse ni asignarse");
+    }
+}
+
+void ConstEvaluator::foldStm(Stm* s) {
+    if (!s) return;
+    switch (s->kind) {
+        case StmKind::BLOCK:
+            for (Stm* st : static_cast<BlockStm*>(s)->statements) foldStm(st);
+            break;
+        case StmKind::LET: {
+            LetStm* let = static_cast<LetStm*>(s);
+            checkNotConstant(let->sym);
+            foldExp(let->init);
+            break;
+        }
+        case StmKind::IF: {
+            IfStm* i = static_cast<IfStm*>(s);
+            foldExp(i->condition);
+            foldStm(i->thenBlock);
+            foldStm(i->elseBlock);
+            break;
+        }
+        case StmKind::WHILE: {
+            WhileStm* w = static_cast<WhileStm*>(s);
+            foldExp(w->condition);
+            foldStm(w->body);
+            break;
+        }
+        case StmKind::FOR: {
+            ForStm* f = static_cast<ForStm*>(s);
+            checkNotConstant(f->iterator);
+            foldExp(f->start);
+            foldExp(f->end);
+            foldStm(f->body);
+            break;
+        }
+        case StmKind::PRINT:
+            foldExp(static_cast<PrintStm*>(s)->e);
+            break;
+        case StmKind::ASSIGN: {
+            AssignStm* a = static_cast<AssignStm*>(s);
+            if (a->id() != "_") checkNotConstant(a->sym);
+            foldExp(a->e);
+            break;
+        }
+        case StmKind::RETURN:
+            foldExp(static_cast<ReturnStm*>(s)->e);
+            break;
+    }
+}
+
+// Con hash-consing un nodo puede colgar de varios padres: se clasifica una
+// sola vez
+ConstEvaluator::Folded ConstEvaluator::foldExp(Exp* e) {
+    if (!e) return VARIABLE;
+    if (!program->sharedExps) return foldNode(e);
+    auto seen = shared.find(e);
+    if (seen != shared.end()) return seen->second;
+    Folded f = foldNode(e);
+    shared.emplace(e, f);
+    return f;
+}
+
+// LITERAL: sólo literales (el generador ya los emite como inmediatos);
+// CONSTANT: depende de alguna constante o const fn y su valor queda en values
+ConstEvaluator::Folded ConstEvaluator::foldNode(Exp* e) {
+    switch (e->kind) {
+        case ExpKind::NUMBER:
+        case ExpKind::BOOL:
+            return LITERAL;
+        case ExpKind::ID: {
+            IdExp* id = static_cast<IdExp*>(e);
+            if (!isConstant(id->sym)) return VARIABLE;
+            (*values)[e] = value(id->sym);
+            return CONSTANT;
+        }
+        case ExpKind::BINARY: {
+            BinaryExp* b = static_cast<BinaryExp*>(e);
+            if (b->op == ASSIGN_OP) {
+                if (IdExp* id = as<IdExp>(b->left)) checkNotConstant(id->sym);
+                else foldExp(b->left);
+                foldExp(b->right);
+                return VARIABLE;
+            }
+            Folded l = foldExp(b->left);
+            Folded r = foldExp(b->right);
+            if (l == VARIABLE || r == VARIABLE) return VARIABLE;
+            if (l == LITERAL && r == LITERAL) return LITERAL;
+            try {
+                steps = 0;
+                (*values)[e] = eval(e, nullptr);
+            } catch (const ConstError&) {
+                return VARIABLE; // p. ej. división por cero: queda para ejecución
+            }
+            return CONSTANT;
+        }
+        case ExpKind::FCALL: {
+            FcallExp* f = static_cast<FcallExp*>(e);
+            bool constantArgs = true;
+            for (Exp* a : f->argumentos) {
+                if (foldExp(a) == VARIABLE) constantArgs = false;
+            }
+            if (!constantArgs || !constFunctions.count(f->sym)) return VARIABLE;
+
+            // El resultado no se trunca: en ejecución el llamador recibe %rax entero
+            pair<SymbolId, vector<int64_t>> key(f->sym, vector<int64_t>());
+            auto memo = calls.end();
+            try {
+                steps = 0;
+                depth = 0;
+                for (Exp* a : f->argumentos) key.second.push_back(eval(a, nullptr));
+                memo = calls.find(key);
+                if (memo == calls.end()) memo = calls.emplace(key, make_pair(true, call(f->sym, key.second))).first;
+            } catch (const ConstError&) {
+                calls.emplace(key, make_pair(false, int64_t(0)));
+                return VARIABLE;
+            }
+            if (!memo->second.first) return VARIABLE;
+            (*values)[e] = memo->second.second;
+            return CONSTANT;
+        }
+        case ExpKind::ARRAY_ACCESS:
+            foldExp(static_cast<ArrayAccessExp*>(e)->index);
+            return VARIABLE;
+        case ExpKind::STRUCT_INIT:
+            for (auto& field : static_cast<StructInitExp*>(e)->fields) foldExp(field.second);
+            return VARIABLE;
+        default:
+            return VARIABLE;
+    }
+}
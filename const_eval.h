@@ -0,0 +1,97 @@
+#ifndef CONST_EVAL_H
+#define CONST_EVAL_H
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "environment.h"
+#include "type_table.h"
+
+using namespace std;
+
+// Expresión o llamada que no puede evaluarse en compilación
+class ConstError : public runtime_error {
+public:
+    explicit ConstError(const string& msg) : runtime_error(msg) {}
+};
+
+// ===========================================================
+//  Evaluación en compilación de const items y const fn.
+//  Un intérprete del AST con la misma aritmética que emite el
+//  generador: enteros de 64 bits, comparaciones 0/1, && en
+//  cortocircuito y variables de 4 bytes truncadas a 32 bits sin
+//  signo (se leen con movl). Las constantes se evalúan bajo
+//  demanda, así que pueden usar otras declaradas más abajo; un
+//  ciclo es un error. Cada evaluación tiene un tope de pasos y
+//  de profundidad de llamadas para que compilar siempre termine.
+//
+//  fold registra el valor de cada uso de una constante y de cada
+//  subárbol que sólo dependa de constantes y de llamadas a const
+//  fn; el generador emite un inmediato en su lugar. El AST no se
+//  modifica: el reparseo incremental reutiliza cuerpos ya
+//  plegados y otra constante puede cambiar su valor.
+// ===========================================================
+
+class ConstEvaluator {
+public:
+    ConstEvaluator(Program* program, TypeTable& types);
+
+    // Evalúa todos los const items y los registra en la TypeTable
+    // (largos de arreglo); valida además los cuerpos de las const fn
+    void evaluateAll();
+
+    bool isConstant(SymbolId name) const { return constants.count(name) != 0; }
+    int64_t value(SymbolId name);
+
+    // Valor de cada expresión constante de los cuerpos; retorna cuántas
+    size_t fold(unordered_map<const Exp*, int64_t>& values);
+
+private:
+    enum State : uint8_t { kPending, kInProgress, kDone };
+    enum Folded : uint8_t { VARIABLE, LITERAL, CONSTANT };
+
+    struct Constant {
+        ConstDec* decl;
+        TypeId type;
+        int64_t value;
+        State state;
+    };
+
+    struct Local {
+        int64_t value;
+        TypeId type;
+    };
+    typedef Environment<Local, SymbolId> Locals;
+
+    Program* program;
+    TypeTable& types;
+    unordered_map<SymbolId, Constant> constants;
+    unordered_map<SymbolId, FunDec*> constFunctions;
+    map<pair<SymbolId, vector<int64_t>>, pair<bool, int64_t>> calls; // memo de fold
+    unordered_map<const Exp*, Folded> shared;                        // nodos ya vistos (hash-consing)
+    unordered_map<const Exp*, int64_t>* values = nullptr;
+    size_t steps = 0;
+    int depth = 0;
+
+    // Intérprete
+    int64_t narrow(int64_t v, TypeId type) const;
+    void step();
+    int64_t eval(Exp* e, Locals* locals);
+    int64_t binary(BinaryExp* e, Locals* locals);
+    int64_t call(SymbolId name, const vector<int64_t>& args);
+    bool exec(Stm* s, Locals& locals, int64_t& result);
+    void validate(FunDec* fd);
+
+    // Plegado
+    void checkNotConstant(SymbolId name) const;
+    Folded foldExp(Exp* e);
+    Folded foldNode(Exp* e);
+    void foldStm(Stm* s);
+};
+
+#endif // CONST_EVAL_H
@@ -1,98 +1,170 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
-template <typename T>
+// ===========================================================
+//  Tabla de símbolos con scopes anidados en una sola tabla.
+//  Cada nombre tiene un slot (direccionamiento abierto, sondeo
+//  lineal) que apunta a su declaración más interna; cada
+//  declaración guarda la que ocultaba (cadena de sombras).
+//  Las declaraciones se apilan en orden (log de deshacer):
+//  pop_scope las retira restaurando lo que ocultaban. Buscar
+//  cuesta O(1) sin importar la profundidad y abrir o cerrar
+//  un scope no reserva memoria.
+//  Los punteros de lookup valen hasta el siguiente declare.
+// ===========================================================
+
+// Key: std::string o SymbolId (nombres internados)
+template <typename T, typename Key = std::string>
 class Environment {
 private:
-    std::vector<std::unordered_map<std::string, T>> scopes;
-
-    int find_scope_index(const std::string& name) const {
-        for (int idx = static_cast<int>(scopes.size()) - 1; idx >= 0; --idx) {
-            const auto& scope = scopes[idx];
-            if (scope.find(name) != scope.end()) {
-                return idx;
-            }
+    static const int32_t kNone = -1;
+
+    struct Slot {
+        Key key{};
+        int32_t top = kNone; // declaración visible de key en entries
+        bool used = false;
+    };
+
+    struct Entry {
+        T value;
+        int32_t shadowed; // declaración que ésta oculta (kNone si ninguna)
+        uint32_t slot;
+    };
+
+    std::vector<Slot> table;         // capacidad potencia de 2, ocupación <= 1/2
+    std::size_t usedSlots = 0;
+    std::vector<Entry> entries;      // declaraciones en orden, de afuera hacia adentro
+    std::vector<std::size_t> marks;  // entries.size() al abrir cada scope
+
+    std::size_t probe(const Key& name) const {
+        std::size_t mask = table.size() - 1;
+        std::size_t i = std::hash<Key>()(name) & mask;
+        while (table[i].used && !(table[i].key == name)) i = (i + 1) & mask;
+        return i;
+    }
+
+    // Slot de name o -1 si nunca se declaró
+    int32_t find_slot(const Key& name) const {
+        if (table.empty()) return kNone;
+        std::size_t i = probe(name);
+        return table[i].used ? static_cast<int32_t>(i) : kNone;
+    }
+
+    int32_t visible_entry(const Key& name) const {
+        int32_t slot = find_slot(name);
+        return slot < 0 ? kNone : table[static_cast<std::size_t>(slot)].top;
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(table);
+        table.assign(old.empty() ? 16 : old.size() * 2, Slot());
+        std::vector<uint32_t> moved(old.size());
+        for (std::size_t i = 0; i < old.size(); i++) {
+            if (!old[i].used) continue;
+            std::size_t j = probe(old[i].key);
+            table[j] = std::move(old[i]);
+            moved[i] = static_cast<uint32_t>(j);
         }
-        return -1;
+        for (Entry& e : entries) e.slot = moved[e.slot];
     }
 
 public:
     Environment() = default;
 
     void clear() {
-        scopes.clear();
+        entries.clear();
+        marks.clear();
+        // Los slots quedan reservados para la próxima función
+        for (Slot& s : table) s.top = kNone;
     }
 
     void push_scope() {
-        scopes.emplace_back();
+        marks.push_back(entries.size());
     }
 
     void pop_scope() {
-        if (scopes.empty()) {
+        if (marks.empty()) {
             throw std::runtime_error("Environment::pop_scope sin scopes disponibles");
         }
-        scopes.pop_back();
+        std::size_t mark = marks.back();
+        marks.pop_back();
+        while (entries.size() > mark) {
+            const Entry& e = entries.back();
+            table[e.slot].top = e.shadowed;
+            entries.pop_back();
+        }
     }
 
     std::size_t depth() const {
-        return scopes.size();
+        return marks.size();
     }
 
     bool empty() const {
-        return scopes.empty();
+        return marks.empty();
     }
 
-    bool declare(const std::string& name, const T& value) {
-        if (scopes.empty()) {
+    bool declare(const Key& name, const T& value) {
+        if (marks.empty()) {
             push_scope();
         }
-        scopes.back()[name] = value;
+        if ((usedSlots + 1) * 2 > table.size()) {
+            grow();
+        }
+        std::size_t i = probe(name);
+        Slot& slot = table[i];
+        if (!slot.used) {
+            slot.used = true;
+            slot.key = name;
+            usedSlots++;
+        }
+        // Redeclarar en el mismo scope reemplaza el valor
+        if (slot.top != kNone && static_cast<std::size_t>(slot.top) >= marks.back()) {
+            entries[static_cast<std::size_t>(slot.top)].value = value;
+            return true;
+        }
+        entries.push_back(Entry{value, slot.top, static_cast<uint32_t>(i)});
+        slot.top = static_cast<int32_t>(entries.size() - 1);
         return true;
     }
 
-    bool assign(const std::string& name, const T& value) {
-        int scopeIndex = find_scope_index(name);
-        if (scopeIndex < 0) {
+    bool assign(const Key& name, const T& value) {
+        T* current = lookup(name);
+        if (!current) {
             return false;
         }
-        scopes[static_cast<std::size_t>(scopeIndex)][name] = value;
+        *current = value;
         return true;
     }
 
-    bool contains(const std::string& name) const {
-        return find_scope_index(name) >= 0;
+    bool contains(const Key& name) const {
+        return visible_entry(name) != kNone;
     }
 
-    bool contains_current_scope(const std::string& name) const {
-        if (scopes.empty()) {
+    bool contains_current_scope(const Key& name) const {
+        if (marks.empty()) {
             return false;
         }
-        return scopes.back().find(name) != scopes.back().end();
+        int32_t top = visible_entry(name);
+        return top != kNone && static_cast<std::size_t>(top) >= marks.back();
     }
 
-    T* lookup(const std::string& name) {
-        int scopeIndex = find_scope_index(name);
-        if (scopeIndex < 0) {
-            return nullptr;
-        }
-        auto& scope = scopes[static_cast<std::size_t>(scopeIndex)];
-        typename std::unordered_map<std::string, T>::iterator it = scope.find(name);
-        return (it != scope.end()) ? &it->second : nullptr;
+    T* lookup(const Key& name) {
+        int32_t top = visible_entry(name);
+        return top == kNone ? nullptr : &entries[static_cast<std::size_t>(top)].value;
     }
 
-    const T* lookup(const std::string& name) const {
-        int scopeIndex = find_scope_index(name);
-        if (scopeIndex < 0) {
-            return nullptr;
-        }
-        const auto& scope = scopes[static_cast<std::size_t>(scopeIndex)];
-        typename std::unordered_map<std::string, T>::const_iterator it = scope.find(name);
-        return (it != scope.end()) ? &it->second : nullptr;
+    const T* lookup(const Key& name) const {
+        int32_t top = visible_entry(name);
+        return top == kNone ? nullptr : &entries[static_cast<std::size_t>(top)].value;
     }
 };
 
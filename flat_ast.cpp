@@ -0,0 +1,712 @@
+#include "flat_ast.h"
+#include "visitor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Construcción desde el AST de punteros
+// -----------------------------------------------------------------------------
+
+namespace {
+
+// Cada visit retorna el índice del nodo creado en la tabla que corresponde
+class FlatBuilder : public Visitor {
+public:
+    FlatAst& ast;
+    unordered_map<string, uint32_t> stringIds;
+
+    explicit FlatBuilder(FlatAst& a) : ast(a) {}
+
+    uint32_t str(const string& s) {
+        auto it = stringIds.find(s);
+        if (it != stringIds.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(ast.strings.size());
+        ast.strings.push_back(s);
+        stringIds.emplace(s, id);
+        return id;
+    }
+
+    FlatAst::Index exp(Exp* e) {
+        return e ? static_cast<FlatAst::Index>(e->accept(this)) : FlatAst::kNull;
+    }
+
+    FlatAst::Index stm(Stm* s) {
+        return s ? static_cast<FlatAst::Index>(s->accept(this)) : FlatAst::kNull;
+    }
+
+    int addExp(ExpKind k, uint32_t offset, FlatAst::Index a, FlatAst::Index b,
+               FlatAst::Index c, int64_t value) {
+        FlatAst::Index id = static_cast<FlatAst::Index>(ast.expKind.size());
+        ast.expKind.push_back(k);
+        ast.expOffset.push_back(offset);
+        ast.expA.push_back(a);
+        ast.expB.push_back(b);
+        ast.expC.push_back(c);
+        ast.expValue.push_back(value);
+        return static_cast<int>(id);
+    }
+
+    int addStm(StmKind k, uint32_t offset, FlatAst::Index a, FlatAst::Index b,
+               FlatAst::Index c, FlatAst::Index d) {
+        FlatAst::Index id = static_cast<FlatAst::Index>(ast.stmKind.size());
+        ast.stmKind.push_back(k);
+        ast.stmOffset.push_back(offset);
+        ast.stmA.push_back(a);
+        ast.stmB.push_back(b);
+        ast.stmC.push_back(c);
+        ast.stmD.push_back(d);
+        return static_cast<int>(id);
+    }
+
+    // Copia un rango ya resuelto al final de lists y retorna su inicio
+    FlatAst::Index appendList(const vector<FlatAst::Index>& items) {
+        FlatAst::Index start = static_cast<FlatAst::Index>(ast.lists.size());
+        ast.lists.insert(ast.lists.end(), items.begin(), items.end());
+        return start;
+    }
+
+    FlatAst::VarDecl varDecl(VarDec* vd) {
+        FlatAst::VarDecl d;
+        d.tipo = vd->tipo;
+        d.variables.assign(vd->variables.begin(), vd->variables.end());
+        return d;
+    }
+
+    int visit(Program* program) override {
+        for (auto ta : program->talist) if (ta) ta->accept(this);
+        for (auto sd : program->sdlist) if (sd) sd->accept(this);
+        for (auto cd : program->cdlist) {
+            if (cd) ast.consts.push_back({cd->sym, cd->tipo, exp(cd->init), cd->offset});
+        }
+        for (auto vd : program->vdlist) if (vd) ast.globals.push_back(varDecl(vd));
+        for (auto fd : program->fdlist) if (fd) fd->accept(this);
+        return 0;
+    }
+
+    int visit(FunDec* function) override {
+        FlatAst::Function f;
+        f.tipo = function->tipo;
+        f.nombre = function->nombre;
+        f.Tparametros = function->Tparametros;
+        f.Nparametros = function->Nparametros;
+        f.offset = function->offset;
+        f.isConst = function->isConst;
+        if (function->cuerpo) {
+            vector<FlatAst::Index> body;
+            for (auto vd : function->cuerpo->vdlist) if (vd) f.vdlist.push_back(varDecl(vd));
+            for (auto s : function->cuerpo->stmlist) if (s) body.push_back(stm(s));
+            f.bodyStart = appendList(body);
+            f.bodyCount = static_cast<FlatAst::Index>(body.size());
+        }
+        ast.functions.push_back(std::move(f));
+        return 0;
+    }
+
+    int visit(Body*) override { return 0; }
+    int visit(VarDec*) override { return 0; }
+
+    int visit(StructDec* sd) override {
+        FlatAst::Struct s;
+        s.name = sd->name;
+        s.fields = sd->fields;
+        s.offset = sd->offset;
+        ast.structs.push_back(std::move(s));
+        return 0;
+    }
+
+    int visit(TypeAlias* ta) override {
+        ast.aliases.push_back({ta->alias, ta->type, ta->offset});
+        return 0;
+    }
+
+    int visit(BlockStm* block) override {
+        vector<FlatAst::Index> items;
+        for (auto s : block->statements) if (s) items.push_back(stm(s));
+        FlatAst::Index start = appendList(items);
+        return addStm(StmKind::BLOCK, block->offset, start,
+                      static_cast<FlatAst::Index>(items.size()), FlatAst::kNull, FlatAst::kNull);
+    }
+
+    int visit(LetStm* s) override {
+        FlatAst::Index init = exp(s->init);
+        return addStm(StmKind::LET, s->offset, s->sym, str(s->type_name), init, s->mutable_flag ? 1 : 0);
+    }
+
+    int visit(IfStm* s) override {
+        FlatAst::Index cond = exp(s->condition);
+        FlatAst::Index thenB = stm(s->thenBlock);
+        FlatAst::Index elseB = stm(s->elseBlock);
+        return addStm(StmKind::IF, s->offset, cond, thenB, elseB, FlatAst::kNull);
+    }
+
+    int visit(WhileStm* s) override {
+        FlatAst::Index cond = exp(s->condition);
+        FlatAst::Index body = stm(s->body);
+        return addStm(StmKind::WHILE, s->offset, cond, body, FlatAst::kNull, FlatAst::kNull);
+    }
+
+    int visit(ForStm* s) override {
+        FlatAst::Index start = exp(s->start);
+        FlatAst::Index end = exp(s->end);
+        FlatAst::Index body = stm(s->body);
+        return addStm(StmKind::FOR, s->offset, s->iterator, start, end, body);
+    }
+
+    int visit(PrintStm* s) override {
+        return addStm(StmKind::PRINT, s->offset, exp(s->e), FlatAst::kNull, FlatAst::kNull, FlatAst::kNull);
+    }
+
+    int visit(AssignStm* s) override {
+        return addStm(StmKind::ASSIGN, s->offset, s->sym, exp(s->e), FlatAst::kNull, FlatAst::kNull);
+    }
+
+    int visit(ReturnStm* s) override {
+        return addStm(StmKind::RETURN, s->offset, exp(s->e), FlatAst::kNull, FlatAst::kNull, FlatAst::kNull);
+    }
+
+    int visit(BinaryExp* e) override {
+        FlatAst::Index l = exp(e->left);
+        FlatAst::Index r = exp(e->right);
+        return addExp(ExpKind::BINARY, e->offset, l, r, FlatAst::kNull, e->op);
+    }
+
+    int visit(NumberExp* e) override {
+        return addExp(ExpKind::NUMBER, e->offset, FlatAst::kNull, FlatAst::kNull, FlatAst::kNull, e->value);
+    }
+
+    int visit(FloatExp* e) override {
+        int64_t bits;
+        memcpy(&bits, &e->value, sizeof(bits));
+        return addExp(ExpKind::FLOAT, e->offset, e->isDouble ? 1 : 0, FlatAst::kNull, FlatAst::kNull, bits);
+    }
+
+    int visit(BoolExp* e) override {
+        return addExp(ExpKind::BOOL, e->offset, FlatAst::kNull, FlatAst::kNull, FlatAst::kNull, e->valor);
+    }
+
+    int visit(IdExp* e) override {
+        return addExp(ExpKind::ID, e->offset, e->sym, FlatAst::kNull, FlatAst::kNull, 0);
+    }
+
+    int visit(FcallExp* e) override {
+        vector<FlatAst::Index> args;
+        for (auto a : e->argumentos) args.push_back(exp(a));
+        FlatAst::Index start = appendList(args);
+        return addExp(ExpKind::FCALL, e->offset, e->sym, start,
+                      static_cast<FlatAst::Index>(args.size()), 0);
+    }
+
+    int visit(ArrayAccessExp* e) override {
+        FlatAst::Index a = exp(e->array);
+        FlatAst::Index i = exp(e->index);
+        return addExp(ExpKind::ARRAY_ACCESS, e->offset, a, i, FlatAst::kNull, 0);
+    }
+
+    int visit(FieldAccessExp* e) override {
+        FlatAst::Index o = exp(e->object);
+        return addExp(ExpKind::FIELD_ACCESS, e->offset, o, str(e->field), FlatAst::kNull, 0);
+    }
+
+    int visit(StructInitExp* e) override {
+        vector<FlatAst::Index> pairs;
+        for (auto& f : e->fields) {
+            FlatAst::Index name = str(f.first);
+            pairs.push_back(name);
+            pairs.push_back(exp(f.second));
+        }
+        FlatAst::Index start = appendList(pairs);
+        return addExp(ExpKind::STRUCT_INIT, e->offset, str(e->name), start,
+                      static_cast<FlatAst::Index>(e->fields.size()), 0);
+    }
+};
+
+} // namespace
+
+FlatAst FlatAst::fromProgram(Program* program) {
+    FlatAst ast;
+    FlatBuilder builder(ast);
+    program->accept(&builder);
+    return ast;
+}
+
+size_t FlatAst::bytes() const {
+    size_t total = expKind.size() * (sizeof(ExpKind) + sizeof(uint32_t) + 3 * sizeof(Index) + sizeof(int64_t));
+    total += stmKind.size() * (sizeof(StmKind) + sizeof(uint32_t) + 4 * sizeof(Index));
+    total += lists.size() * sizeof(Index);
+    for (auto& s : strings) total += s.size();
+    return total;
+}
+
+// -----------------------------------------------------------------------------
+// Reconstrucción del AST de punteros (en la arena de un Program nuevo)
+// -----------------------------------------------------------------------------
+
+namespace {
+
+class Materializer {
+public:
+    const FlatAst& ast;
+    Arena& arena;
+
+    Materializer(const FlatAst& a, Arena& ar) : ast(a), arena(ar) {}
+
+    template <typename T>
+    T* at(uint32_t offset, T* node) {
+        node->offset = offset;
+        return node;
+    }
+
+    Exp* exp(FlatAst::Index i) {
+        if (i == FlatAst::kNull) return nullptr;
+        uint32_t off = ast.expOffset[i];
+        FlatAst::Index a = ast.expA[i], b = ast.expB[i], c = ast.expC[i];
+        switch (ast.expKind[i]) {
+            case ExpKind::BINARY: {
+                Exp* l = exp(a);
+                Exp* r = exp(b);
+                return at(off, arena.make<BinaryExp>(l, r, static_cast<BinaryOp>(ast.expValue[i])));
+            }
+            case ExpKind::NUMBER:
+                return at(off, arena.make<NumberExp>(ast.expValue[i]));
+            case ExpKind::FLOAT: {
+                double v;
+                memcpy(&v, &ast.expValue[i], sizeof(v));
+                return at(off, arena.make<FloatExp>(v, a != 0));
+            }
+            case ExpKind::BOOL:
+                return at(off, arena.make<BoolExp>(static_cast<int>(ast.expValue[i])));
+            case ExpKind::ID:
+                return at(off, arena.make<IdExp>(a));
+            case ExpKind::FCALL: {
+                FcallExp* e = at(off, arena.make<FcallExp>());
+                e->sym = a;
+                for (FlatAst::Index k = 0; k < c; k++) e->argumentos.push_back(exp(ast.lists[b + k]));
+                return e;
+            }
+            case ExpKind::ARRAY_ACCESS: {
+                Exp* arr = exp(a);
+                Exp* idx = exp(b);
+                return at(off, arena.make<ArrayAccessExp>(arr, idx));
+            }
+            case ExpKind::FIELD_ACCESS:
+                return at(off, arena.make<FieldAccessExp>(exp(a), ast.strings[b]));
+            case ExpKind::STRUCT_INIT: {
+                StructInitExp* e = at(off, arena.make<StructInitExp>(ast.strings[a]));
+                for (FlatAst::Index k = 0; k < c; k++) {
+                    const string& field = ast.strings[ast.lists[b + 2 * k]];
+                    e->fields.push_back({field, exp(ast.lists[b + 2 * k + 1])});
+                }
+                return e;
+            }
+        }
+        throw runtime_error("FlatAst: clase de expresión desconocida");
+    }
+
+    BlockStm* block(FlatAst::Index i) {
+        return static_cast<BlockStm*>(stm(i));
+    }
+
+    Stm* stm(FlatAst::Index i) {
+        if (i == FlatAst::kNull) return nullptr;
+        uint32_t off = ast.stmOffset[i];
+        FlatAst::Index a = ast.stmA[i], b = ast.stmB[i], c = ast.stmC[i], d = ast.stmD[i];
+        switch (ast.stmKind[i]) {
+            case StmKind::BLOCK: {
+                BlockStm* s = at(off, arena.make<BlockStm>());
+                for (FlatAst::Index k = 0; k < b; k++) s->statements.push_back(stm(ast.lists[a + k]));
+                return s;
+            }
+            case StmKind::LET:
+                return at(off, arena.make<LetStm>(d != 0, a, ast.strings[b], exp(c)));
+            case StmKind::IF: {
+                Exp* cond = exp(a);
+                BlockStm* thenB = block(b);
+                BlockStm* elseB = block(c);
+                return at(off, arena.make<IfStm>(cond, thenB, elseB));
+            }
+            case StmKind::WHILE: {
+                Exp* cond = exp(a);
+                return at(off, arena.make<WhileStm>(cond, block(b)));
+            }
+            case StmKind::FOR: {
+                Exp* start = exp(b);
+                Exp* end = exp(c);
+                return at(off, arena.make<ForStm>(a, start, end, block(d)));
+            }
+            case StmKind::PRINT:
+                return at(off, arena.make<PrintStm>(exp(a)));
+            case StmKind::ASSIGN:
+                return at(off, arena.make<AssignStm>(a, exp(b)));
+            case StmKind::RETURN: {
+                ReturnStm* s = at(off, arena.make<ReturnStm>());
+                s->e = exp(a);
+                return s;
+            }
+        }
+        throw runtime_error("FlatAst: clase de sentencia desconocida");
+    }
+
+    VarDec* varDec(const FlatAst::VarDecl& d) {
+        VarDec* vd = arena.make<VarDec>();
+        vd->tipo = d.tipo;
+        vd->variables.assign(d.variables.begin(), d.variables.end());
+        return vd;
+    }
+
+    ConstDec* constDec(const FlatAst::Const& c) {
+        return at(c.offset, arena.make<ConstDec>(c.sym, c.tipo, exp(c.init)));
+    }
+
+    FunDec* function(const FlatAst::Function& f) {
+        FunDec* fd = at(f.offset, arena.make<FunDec>());
+        fd->tipo = f.tipo;
+        fd->nombre = f.nombre;
+        fd->Tparametros = f.Tparametros;
+        fd->Nparametros = f.Nparametros;
+        fd->isConst = f.isConst;
+        fd->cuerpo = arena.make<Body>();
+        for (auto& vd : f.vdlist) fd->cuerpo->vdlist.push_back(varDec(vd));
+        for (FlatAst::Index k = 0; k < f.bodyCount; k++) fd->cuerpo->stmlist.push_back(stm(ast.lists[f.bodyStart + k]));
+        return fd;
+    }
+};
+
+} // namespace
+
+Program* FlatAst::materialize() const {
+    Program* p = new Program();
+    Materializer m(*this, p->arena);
+    for (auto& a : aliases) {
+        p->talist.push_back(m.at(a.offset, p->arena.make<TypeAlias>(a.alias, a.type)));
+    }
+    for (auto& s : structs) {
+        StructDec* sd = m.at(s.offset, p->arena.make<StructDec>(s.name));
+        sd->fields = s.fields;
+        p->sdlist.push_back(sd);
+    }
+    for (auto& c : consts) p->cdlist.push_back(m.constDec(c));
+    for (auto& g : globals) p->vdlist.push_back(m.varDec(g));
+    for (auto& f : functions) p->fdlist.push_back(m.function(f));
+    return p;
+}
+
+// -----------------------------------------------------------------------------
+// Serialización binaria
+// -----------------------------------------------------------------------------
+
+namespace {
+
+const char kFlatMagic[4] = {'F', 'A', 'S', 'T'};
+const uint32_t kFlatVersion = 2;
+
+void put32(ostream& os, uint32_t v) { os.write(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+template <typename T>
+void putVec(ostream& os, const vector<T>& v) {
+    put32(os, static_cast<uint32_t>(v.size()));
+    if (!v.empty()) os.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+void putStr(ostream& os, const string& s) {
+    put32(os, static_cast<uint32_t>(s.size()));
+    os.write(s.data(), s.size());
+}
+
+void putStrings(ostream& os, const vector<string>& v) {
+    put32(os, static_cast<uint32_t>(v.size()));
+    for (auto& s : v) putStr(os, s);
+}
+
+void putVarDecls(ostream& os, const vector<FlatAst::VarDecl>& v) {
+    put32(os, static_cast<uint32_t>(v.size()));
+    for (auto& d : v) { putStr(os, d.tipo); putStrings(os, d.variables); }
+}
+
+// Lectura acotada por los bytes que quedan en el archivo: una cantidad
+// corrupta falla con runtime_error antes de reservar memoria
+class Reader {
+private:
+    istream& is;
+    uint64_t left = 0;
+
+public:
+    explicit Reader(istream& in) : is(in) {
+        streampos here = is.tellg();
+        is.seekg(0, ios::end);
+        streampos end = is.tellg();
+        is.seekg(here);
+        if (here < 0 || end < here || !is) throw runtime_error("FlatAst: no se puede medir el archivo");
+        left = static_cast<uint64_t>(end - here);
+    }
+
+    void bytes(void* dst, size_t n) {
+        if (n > left || !is.read(static_cast<char*>(dst), n)) throw runtime_error("FlatAst: archivo truncado");
+        left -= n;
+    }
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        bytes(&v, sizeof(v));
+        return v;
+    }
+
+    // Largo de una lista cuyos elementos ocupan al menos minBytes cada uno
+    uint32_t count(size_t minBytes) {
+        uint32_t n = u32();
+        if (static_cast<uint64_t>(n) * minBytes > left) throw runtime_error("FlatAst: largo fuera del archivo");
+        return n;
+    }
+
+    template <typename T>
+    void vec(vector<T>& v) {
+        v.resize(count(sizeof(T)));
+        if (!v.empty()) bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    string str() {
+        string s(count(1), '\0');
+        if (!s.empty()) bytes(&s[0], s.size());
+        return s;
+    }
+
+    void strings(vector<string>& v) {
+        v.resize(count(4));
+        for (auto& s : v) s = str();
+    }
+
+    void varDecls(vector<FlatAst::VarDecl>& v) {
+        v.resize(count(8));
+        for (auto& d : v) { d.tipo = str(); strings(d.variables); }
+    }
+};
+
+// Columnas que guardan SymbolId según la clase de nodo
+bool expHasSym(ExpKind k) { return k == ExpKind::ID || k == ExpKind::FCALL; }
+bool stmHasSym(StmKind k) { return k == StmKind::LET || k == StmKind::FOR || k == StmKind::ASSIGN; }
+
+// Comprueba que todo índice de un FlatAst leído caiga dentro de su tabla,
+// así materialize() y los recorridos nunca leen fuera de los vectores.
+// Como FlatBuilder agrega los hijos antes que el padre, un hijo siempre
+// tiene índice menor: eso además descarta ciclos.
+class Validator {
+private:
+    const FlatAst& ast;
+
+    static void fail(const char* what) { throw runtime_error(string("FlatAst: ") + what + " fuera de rango"); }
+
+    void exp(FlatAst::Index i, size_t parent, bool optional = false) {
+        if (i == FlatAst::kNull ? !optional : i >= parent) fail("expresión");
+    }
+    void stm(FlatAst::Index i, size_t parent, bool optional = false) {
+        if (i == FlatAst::kNull ? !optional : i >= parent) fail("sentencia");
+    }
+    void block(FlatAst::Index i, size_t parent, bool optional = false) {
+        stm(i, parent, optional);
+        if (i != FlatAst::kNull && ast.stmKind[i] != StmKind::BLOCK) fail("bloque");
+    }
+    void str(FlatAst::Index i) {
+        if (i >= ast.strings.size()) fail("string");
+    }
+    // Rango [start, start + n * width) de lists
+    void range(FlatAst::Index start, FlatAst::Index n, uint64_t width) {
+        if (start + n * width > ast.lists.size()) fail("rango de lists");
+    }
+
+public:
+    explicit Validator(const FlatAst& a) : ast(a) {}
+
+    void run() {
+        size_t ne = ast.expCount(), ns = ast.stmCount();
+        for (size_t i = 0; i < ne; i++) {
+            FlatAst::Index a = ast.expA[i], b = ast.expB[i], c = ast.expC[i];
+            switch (ast.expKind[i]) {
+                case ExpKind::BINARY:
+                    if (ast.expValue[i] < PLUS_OP || ast.expValue[i] > ASSIGN_OP) fail("operador");
+                    exp(a, i); exp(b, i);
+                    break;
+                case ExpKind::NUMBER: case ExpKind::FLOAT: case ExpKind::BOOL: case ExpKind::ID:
+                    break;
+                case ExpKind::FCALL:
+                    range(b, c, 1);
+                    for (FlatAst::Index k = 0; k < c; k++) exp(ast.lists[b + k], i);
+                    break;
+                case ExpKind::ARRAY_ACCESS:
+                    exp(a, i); exp(b, i);
+                    break;
+                case ExpKind::FIELD_ACCESS:
+                    exp(a, i); str(b);
+                    break;
+                case ExpKind::STRUCT_INIT:
+                    str(a);
+                    range(b, c, 2);
+                    for (FlatAst::Index k = 0; k < c; k++) {
+                        str(ast.lists[b + 2 * k]);
+                        exp(ast.lists[b + 2 * k + 1], i);
+                    }
+                    break;
+                default:
+                    fail("clase de expresión");
+            }
+        }
+        for (size_t i = 0; i < ns; i++) {
+            FlatAst::Index a = ast.stmA[i], b = ast.stmB[i], c = ast.stmC[i], d = ast.stmD[i];
+            switch (ast.stmKind[i]) {
+                case StmKind::BLOCK:
+                    range(a, b, 1);
+                    for (FlatAst::Index k = 0; k < b; k++) stm(ast.lists[a + k], i);
+                    break;
+                case StmKind::LET:
+                    str(b); exp(c, ne, true);
+                    break;
+                case StmKind::IF:
+                    exp(a, ne); block(b, i); block(c, i, true);
+                    break;
+                case StmKind::WHILE:
+                    exp(a, ne); block(b, i);
+                    break;
+                case StmKind::FOR:
+                    exp(b, ne); exp(c, ne); block(d, i);
+                    break;
+                case StmKind::PRINT:
+                    exp(a, ne);
+                    break;
+                case StmKind::ASSIGN:
+                    exp(b, ne);
+                    break;
+                case StmKind::RETURN:
+                    exp(a, ne, true);
+                    break;
+                default:
+                    fail("clase de sentencia");
+            }
+        }
+        for (auto& f : ast.functions) {
+            range(f.bodyStart, f.bodyCount, 1);
+            for (FlatAst::Index k = 0; k < f.bodyCount; k++) stm(ast.lists[f.bodyStart + k], ns);
+        }
+        for (auto& c : ast.consts) exp(c.init, ne);
+    }
+};
+
+} // namespace
+
+void FlatAst::write(ostream& os) const {
+    os.write(kFlatMagic, sizeof(kFlatMagic));
+    put32(os, kFlatVersion);
+
+    // Nombres de los símbolos usados (id del proceso actual -> nombre)
+    vector<SymbolId> syms;
+    for (size_t i = 0; i < expKind.size(); i++) if (expHasSym(expKind[i])) syms.push_back(expA[i]);
+    for (size_t i = 0; i < stmKind.size(); i++) if (stmHasSym(stmKind[i])) syms.push_back(stmA[i]);
+    for (auto& f : functions) syms.insert(syms.end(), f.Nparametros.begin(), f.Nparametros.end());
+    for (auto& c : consts) syms.push_back(c.sym);
+    sort(syms.begin(), syms.end());
+    syms.erase(unique(syms.begin(), syms.end()), syms.end());
+    put32(os, static_cast<uint32_t>(syms.size()));
+    for (SymbolId s : syms) {
+        put32(os, s);
+        putStr(os, global_interner().name(s));
+    }
+
+    putVec(os, expKind); putVec(os, expOffset);
+    putVec(os, expA); putVec(os, expB); putVec(os, expC); putVec(os, expValue);
+    putVec(os, stmKind); putVec(os, stmOffset);
+    putVec(os, stmA); putVec(os, stmB); putVec(os, stmC); putVec(os, stmD);
+    putVec(os, lists);
+    putStrings(os, strings);
+
+    put32(os, static_cast<uint32_t>(functions.size()));
+    for (auto& f : functions) {
+        putStr(os, f.tipo);
+        putStr(os, f.nombre);
+        putStrings(os, f.Tparametros);
+        putVec(os, f.Nparametros);
+        putVarDecls(os, f.vdlist);
+        put32(os, f.bodyStart);
+        put32(os, f.bodyCount);
+        put32(os, f.offset);
+        put32(os, f.isConst ? 1 : 0);
+    }
+    put32(os, static_cast<uint32_t>(structs.size()));
+    for (auto& s : structs) {
+        putStr(os, s.name);
+        put32(os, static_cast<uint32_t>(s.fields.size()));
+        for (auto& fl : s.fields) { putStr(os, fl.first); putStr(os, fl.second); }
+        put32(os, s.offset);
+    }
+    put32(os, static_cast<uint32_t>(aliases.size()));
+    for (auto& a : aliases) { putStr(os, a.alias); putStr(os, a.type); put32(os, a.offset); }
+    put32(os, static_cast<uint32_t>(consts.size()));
+    for (auto& c : consts) { put32(os, c.sym); putStr(os, c.tipo); put32(os, c.init); put32(os, c.offset); }
+    putVarDecls(os, globals);
+}
+
+FlatAst FlatAst::read(istream& is) {
+    Reader in(is);
+    char magic[4];
+    in.bytes(magic, sizeof(magic));
+    if (memcmp(magic, kFlatMagic, sizeof(magic)) != 0) throw runtime_error("FlatAst: formato no reconocido");
+    if (in.u32() != kFlatVersion) throw runtime_error("FlatAst: versión no soportada");
+
+    unordered_map<SymbolId, SymbolId> remap;
+    uint32_t symCount = in.count(8);
+    for (uint32_t i = 0; i < symCount; i++) {
+        SymbolId old = in.u32();
+        remap[old] = global_interner().intern(in.str());
+    }
+    auto sym = [&](SymbolId old) {
+        auto it = remap.find(old);
+        if (it == remap.end()) throw runtime_error("FlatAst: símbolo sin nombre");
+        return it->second;
+    };
+
+    FlatAst ast;
+    in.vec(ast.expKind); in.vec(ast.expOffset);
+    in.vec(ast.expA); in.vec(ast.expB); in.vec(ast.expC); in.vec(ast.expValue);
+    in.vec(ast.stmKind); in.vec(ast.stmOffset);
+    in.vec(ast.stmA); in.vec(ast.stmB); in.vec(ast.stmC); in.vec(ast.stmD);
+    in.vec(ast.lists);
+    in.strings(ast.strings);
+
+    ast.functions.resize(in.count(36));
+    for (auto& f : ast.functions) {
+        f.tipo = in.str();
+        f.nombre = in.str();
+        in.strings(f.Tparametros);
+        in.vec(f.Nparametros);
+        for (auto& p : f.Nparametros) p = sym(p);
+        in.varDecls(f.vdlist);
+        f.bodyStart = in.u32();
+        f.bodyCount = in.u32();
+        f.offset = in.u32();
+        f.isConst = in.u32() != 0;
+    }
+    ast.structs.resize(in.count(12));
+    for (auto& s : ast.structs) {
+        s.name = in.str();
+        s.fields.resize(in.count(8));
+        for (auto& fl : s.fields) { fl.first = in.str(); fl.second = in.str(); }
+        s.offset = in.u32();
+    }
+    ast.aliases.resize(in.count(12));
+    for (auto& a : ast.aliases) { a.alias = in.str(); a.type = in.str(); a.offset = in.u32(); }
+    ast.consts.resize(in.count(16));
+    for (auto& c : ast.consts) { c.sym = sym(in.u32()); c.tipo = in.str(); c.init = in.u32(); c.offset = in.u32(); }
+    in.varDecls(ast.globals);
+
+    size_t ne = ast.expKind.size(), ns = ast.stmKind.size();
+    if (ast.expOffset.size() != ne || ast.expA.size() != ne || ast.expB.size() != ne ||
+        ast.expC.size() != ne || ast.expValue.size() != ne || ast.stmOffset.size() != ns ||
+        ast.stmA.size() != ns || ast.stmB.size() != ns || ast.stmC.size() != ns || ast.stmD.size() != ns) {
+        throw runtime_error("FlatAst: columnas inconsistentes");
+    }
+    Validator(ast).run();
+    for (size_t i = 0; i < ast.expKind.size(); i++) if (expHasSym(ast.expKind[i])) ast.expA[i] = sym(ast.expA[i]);
+    for (size_t i = 0; i < ast.stmKind.size(); i++) if (stmHasSym(ast.stmKind[i])) ast.stmA[i] = sym(ast.stmA[i]);
+    return ast;
+}
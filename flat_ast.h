@@ -0,0 +1,121 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+// ===========================================================
+//  AST plano en forma structure-of-arrays.
+//  Expresiones y sentencias viven en columnas paralelas (una
+//  fila por nodo) y los hijos se referencian con índices de 32
+//  bits. Los hijos de longitud variable (sentencias de un bloque,
+//  argumentos, campos de un struct init) son rangos contiguos de
+//  `lists`. Copiar o serializar el árbol es copiar vectores.
+//
+//  Columnas por clase de nodo (a, b, c, d / value):
+//    BINARY        left, right, -        value = BinaryOp
+//    NUMBER        -                     value = literal
+//    FLOAT         isDouble              value = bits del double
+//    BOOL          -                     value = 0/1
+//    ID            sym
+//    FCALL         sym, inicio, cantidad (argumentos en lists)
+//    ARRAY_ACCESS  array, index
+//    FIELD_ACCESS  object, campo (strings)
+//    STRUCT_INIT   nombre (strings), inicio, cantidad
+//                  (pares campo/expresión en lists)
+//
+//    BLOCK         inicio, cantidad (sentencias en lists)
+//    LET           sym, tipo (strings), init, mutable
+//    IF            cond, then, else
+//    WHILE         cond, body
+//    FOR           sym, start, end, body
+//    PRINT         exp
+//    ASSIGN        sym, exp
+//    RETURN        exp
+// ===========================================================
+
+class FlatAst {
+public:
+    typedef uint32_t Index;
+    static const Index kNull = 0xFFFFFFFFu;
+
+    // Expresiones
+    vector<ExpKind> expKind;
+    vector<uint32_t> expOffset;
+    vector<Index> expA, expB, expC;
+    vector<int64_t> expValue;
+
+    // Sentencias
+    vector<StmKind> stmKind;
+    vector<uint32_t> stmOffset;
+    vector<Index> stmA, stmB, stmC, stmD;
+
+    vector<Index> lists;     // hijos de longitud variable
+    vector<string> strings;  // nombres de tipo, campo y struct
+
+    struct VarDecl {
+        string tipo;
+        vector<string> variables;
+    };
+
+    struct Function {
+        string tipo;
+        string nombre;
+        vector<string> Tparametros;
+        vector<SymbolId> Nparametros;
+        vector<VarDecl> vdlist;
+        Index bodyStart = 0;  // sentencias del cuerpo en lists
+        Index bodyCount = 0;
+        uint32_t offset = 0;
+        bool isConst = false;
+    };
+
+    struct Struct {
+        string name;
+        vector<pair<string, string>> fields;
+        uint32_t offset = 0;
+    };
+
+    struct Alias {
+        string alias;
+        string type;
+        uint32_t offset = 0;
+    };
+
+    struct Const {
+        SymbolId sym;
+        string tipo;
+        Index init = kNull;  // expresión
+        uint32_t offset = 0;
+    };
+
+    vector<Function> functions;
+    vector<Struct> structs;
+    vector<Alias> aliases;
+    vector<Const> consts;
+    vector<VarDecl> globals;
+
+    size_t expCount() const { return expKind.size(); }
+    size_t stmCount() const { return stmKind.size(); }
+
+    // Bytes ocupados por las columnas (estadística)
+    size_t bytes() const;
+
+    // Conversión desde/hacia el AST de punteros
+    static FlatAst fromProgram(Program* program);
+    Program* materialize() const;
+
+    // Formato binario propio. Los SymbolId se guardan junto a su nombre
+    // y se re-internan al leer, así el archivo no depende del proceso.
+    void write(ostream& os) const;
+    static FlatAst read(istream& is);
+};
+
+#endif // FLAT_AST_H
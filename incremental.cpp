@@ -0,0 +1,255 @@
+#include "incremental.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+#include "scanner.h"
+#include "parser.h"
+
+using namespace std;
+
+namespace {
+
+// Desplaza los offsets de un subárbol. Con hash-consing una expresión
+// pura puede colgar de varios padres: seen evita moverla dos veces.
+class OffsetShifter {
+private:
+    int64_t delta;
+    bool shared;
+    unordered_set<Exp*> seen;
+
+    void shift(uint32_t& offset) { offset = static_cast<uint32_t>(offset + delta); }
+
+public:
+    OffsetShifter(int64_t d, bool sharedExps) : delta(d), shared(sharedExps) {}
+
+    void exp(Exp* e) {
+        if (!e) return;
+        if (shared && e->hash && !seen.insert(e).second) return;
+        shift(e->offset);
+        switch (e->kind) {
+            case ExpKind::BINARY: {
+                BinaryExp* bin = static_cast<BinaryExp*>(e);
+                exp(bin->left);
+                exp(bin->right);
+                break;
+            }
+            case ExpKind::FCALL:
+                for (Exp* a : static_cast<FcallExp*>(e)->argumentos) exp(a);
+                break;
+            case ExpKind::ARRAY_ACCESS: {
+                ArrayAccessExp* a = static_cast<ArrayAccessExp*>(e);
+                exp(a->array);
+                exp(a->index);
+                break;
+            }
+            case ExpKind::FIELD_ACCESS:
+                exp(static_cast<FieldAccessExp*>(e)->object);
+                break;
+            case ExpKind::STRUCT_INIT:
+                for (auto& f : static_cast<StructInitExp*>(e)->fields) exp(f.second);
+                break;
+            case ExpKind::NUMBER: case ExpKind::FLOAT: case ExpKind::BOOL: case ExpKind::ID:
+                break;
+        }
+    }
+
+    void stm(Stm* s) {
+        if (!s) return;
+        shift(s->offset);
+        switch (s->kind) {
+            case StmKind::BLOCK:
+                for (Stm* c : static_cast<BlockStm*>(s)->statements) stm(c);
+                break;
+            case StmKind::LET:
+                exp(static_cast<LetStm*>(s)->init);
+                break;
+            case StmKind::IF: {
+                IfStm* i = static_cast<IfStm*>(s);
+                exp(i->condition);
+                stm(i->thenBlock);
+                stm(i->elseBlock);
+                break;
+            }
+            case StmKind::WHILE: {
+                WhileStm* w = static_cast<WhileStm*>(s);
+                exp(w->condition);
+                stm(w->body);
+                break;
+            }
+            case StmKind::FOR: {
+                ForStm* f = static_cast<ForStm*>(s);
+                exp(f->start);
+                exp(f->end);
+                stm(f->body);
+                break;
+            }
+            case StmKind::PRINT: exp(static_cast<PrintStm*>(s)->e); break;
+            case StmKind::ASSIGN: exp(static_cast<AssignStm*>(s)->e); break;
+            case StmKind::RETURN: exp(static_cast<ReturnStm*>(s)->e); break;
+        }
+    }
+
+    void function(FunDec* fd, int64_t tokenDelta) {
+        shift(fd->offset);
+        if (fd->cuerpo) {
+            for (Stm* s : fd->cuerpo->stmlist) stm(s);
+        } else {
+            // Cuerpo diferido: sus índices de token siguen al buffer nuevo
+            fd->bodyBegin = static_cast<uint32_t>(fd->bodyBegin + tokenDelta);
+            fd->bodyEnd = static_cast<uint32_t>(fd->bodyEnd + tokenDelta);
+        }
+    }
+
+    void structDec(StructDec* sd) { shift(sd->offset); }
+    void alias(TypeAlias* ta) { shift(ta->offset); }
+
+    void constDec(ConstDec* cd) {
+        shift(cd->offset);
+        exp(cd->init);
+    }
+};
+
+// Item top-level a profundidad 0: índice de su primer token
+bool startsItem(Token::Type k) {
+    return k == Token::FN || k == Token::STRUCT || k == Token::TYPE || k == Token::CONST;
+}
+
+vector<size_t> itemStarts(const TokenBuffer& tokens) {
+    vector<size_t> starts;
+    int depth = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        Token::Type k = tokens.kind(i);
+        if (k == Token::LBRACE) depth++;
+        else if (k == Token::RBRACE) depth--;
+        else if (depth == 0 && startsItem(k)) {
+            // `const fn` es un solo item que empieza en const
+            if (k == Token::FN && i > 0 && tokens.kind(i - 1) == Token::CONST) continue;
+            starts.push_back(i);
+        }
+    }
+    return starts;
+}
+
+// Copia tokens [from, to) de src al final de dst desplazando sus offsets
+void appendShifted(TokenBuffer& dst, const TokenBuffer& src, size_t from, size_t to, int64_t delta) {
+    size_t at = dst.offsets.size();
+    dst.kinds.insert(dst.kinds.end(), src.kinds.begin() + from, src.kinds.begin() + to);
+    dst.offsets.insert(dst.offsets.end(), src.offsets.begin() + from, src.offsets.begin() + to);
+    dst.lengths.insert(dst.lengths.end(), src.lengths.begin() + from, src.lengths.begin() + to);
+    dst.symbols.insert(dst.symbols.end(), src.symbols.begin() + from, src.symbols.begin() + to);
+    if (delta == 0) return;
+    uint32_t shift = static_cast<uint32_t>(delta); // aritmética módulo 2^32
+    for (size_t i = at; i < dst.offsets.size(); i++) dst.offsets[i] += shift;
+}
+
+template <typename T>
+void replaceInList(vector<T*>& list, T* old, T* fresh) {
+    auto it = find(list.begin(), list.end(), old);
+    if (it != list.end()) list.erase(it);
+    if (!fresh) return;
+    // Las listas del Program están en orden de fuente
+    auto at = lower_bound(list.begin(), list.end(), fresh,
+                          [](const T* a, const T* b) { return a->offset < b->offset; });
+    list.insert(at, fresh);
+}
+
+ReparseResult fullReparse(const char* newSource, size_t newSize, TokenBuffer& tokens, Program*& program) {
+    TokenBuffer fresh;
+    Scanner scanner(newSource, newSize);
+    scanner.tokenize(fresh);
+    Parser parser(&fresh);
+    Program* p = parser.parseProgram();
+    delete program;
+    program = p;
+    tokens = std::move(fresh);
+
+    ReparseResult result;
+    result.relexedTokens = tokens.size();
+    return result;
+}
+
+} // namespace
+
+ReparseResult reparseEdit(const char* newSource, size_t newSize, const SourceEdit& edit,
+                          TokenBuffer& tokens, Program*& program) {
+    if (tokens.empty() || !program) return fullReparse(newSource, newSize, tokens, program);
+
+    // Item cuyo tramo [inicio, inicio del siguiente) contiene el cambio
+    vector<size_t> starts = itemStarts(tokens);
+    size_t n = tokens.size();
+    size_t oldSize = tokens.offsets[n - 1]; // END está al final del fuente
+    auto itemBegin = [&](size_t k) { return k < starts.size() ? tokens.offsets[starts[k]] : oldSize; };
+    auto upper = upper_bound(starts.begin(), starts.end(), edit.start,
+                             [&](uint32_t off, size_t idx) { return off < tokens.offsets[idx]; });
+    if (upper == starts.begin() || edit.oldEnd > oldSize) {
+        return fullReparse(newSource, newSize, tokens, program);
+    }
+    size_t k = static_cast<size_t>(upper - starts.begin()) - 1;
+    bool last = k + 1 == starts.size();
+    if (edit.oldEnd > itemBegin(k + 1)) {
+        // El cambio alcanza al item siguiente
+        return fullReparse(newSource, newSize, tokens, program);
+    }
+
+    int64_t delta = static_cast<int64_t>(edit.newEnd) - static_cast<int64_t>(edit.oldEnd);
+    size_t regionBegin = itemBegin(k);
+    size_t regionEnd = static_cast<size_t>(static_cast<int64_t>(itemBegin(k + 1)) + delta);
+    size_t oldFirst = starts[k];
+    size_t oldStop = last ? n : starts[k + 1]; // el último item incluye END
+
+    // Re-lexear sólo el tramo; debe volver a coincidir en regionEnd
+    TokenBuffer region;
+    Scanner scanner(newSource, newSize);
+    if (!scanner.tokenizeUntil(region, regionBegin, regionEnd) || region.empty()) {
+        return fullReparse(newSource, newSize, tokens, program);
+    }
+
+    TokenBuffer spliced;
+    spliced.source = newSource;
+    spliced.reserve(n - (oldStop - oldFirst) + region.size());
+    appendShifted(spliced, tokens, 0, oldFirst, 0);
+    appendShifted(spliced, region, 0, region.size(), 0);
+    appendShifted(spliced, tokens, oldStop, n, delta);
+    int64_t tokenDelta = static_cast<int64_t>(region.size()) - static_cast<int64_t>(oldStop - oldFirst);
+
+    // Reparsear sólo ese item; tiene que terminar donde empieza el siguiente
+    Parser parser(&spliced);
+    size_t end = 0;
+    Parser::Item item = parser.parseItemAt(program, oldFirst, end);
+    size_t expectedEnd = last ? spliced.size() - 1 : oldFirst + region.size();
+    if (end != expectedEnd) {
+        return fullReparse(newSource, newSize, tokens, program);
+    }
+
+    // Reemplazar el item en su lista y mover los offsets de los siguientes
+    uint32_t oldItemOffset = static_cast<uint32_t>(regionBegin);
+    FunDec* oldFn = nullptr;
+    StructDec* oldSd = nullptr;
+    TypeAlias* oldTa = nullptr;
+    ConstDec* oldCd = nullptr;
+    for (FunDec* fd : program->fdlist) if (fd->offset == oldItemOffset) oldFn = fd;
+    for (StructDec* sd : program->sdlist) if (sd->offset == oldItemOffset) oldSd = sd;
+    for (TypeAlias* ta : program->talist) if (ta->offset == oldItemOffset) oldTa = ta;
+    for (ConstDec* cd : program->cdlist) if (cd->offset == oldItemOffset) oldCd = cd;
+
+    ReparseResult result;
+    result.incremental = true;
+    result.relexedTokens = region.size();
+    if (delta != 0 || tokenDelta != 0) {
+        OffsetShifter shifter(delta, program->sharedExps);
+        for (FunDec* fd : program->fdlist) if (fd->offset > oldItemOffset) shifter.function(fd, tokenDelta);
+        for (StructDec* sd : program->sdlist) if (sd->offset > oldItemOffset) shifter.structDec(sd);
+        for (TypeAlias* ta : program->talist) if (ta->offset > oldItemOffset) shifter.alias(ta);
+        for (ConstDec* cd : program->cdlist) if (cd->offset > oldItemOffset) shifter.constDec(cd);
+    }
+    replaceInList(program->fdlist, oldFn, item.function);
+    replaceInList(program->sdlist, oldSd, item.structDec);
+    replaceInList(program->talist, oldTa, item.alias);
+    replaceInList(program->cdlist, oldCd, item.constDec);
+    result.reusedItems = program->fdlist.size() + program->sdlist.size() + program->talist.size() +
+                         program->cdlist.size() - 1;
+
+    tokens = std::move(spliced);
+    return result;
+}
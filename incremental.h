@@ -0,0 +1,43 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "token.h"
+#include "ast.h"
+
+using namespace std;
+
+// ===========================================================
+//  Reparseo incremental para el editor del simulador.
+//  Un cambio que cae dentro de un único item top-level (fn,
+//  struct, type o const) sólo re-lexea el texto de ese item y
+//  sólo reparsea ese item; los demás FunDec/StructDec/TypeAlias/
+//  ConstDec se reutilizan tal cual (sólo se desplazan sus
+//  offsets). Si el
+//  cambio cruza items, o el lexeo del tramo no vuelve a
+//  coincidir con el resto del archivo, se lexea y parsea todo.
+//  Los nodos reemplazados quedan en la arena del Program hasta
+//  su teardown.
+// ===========================================================
+
+// [start, oldEnd) del fuente anterior pasó a ser [start, newEnd) del nuevo
+struct SourceEdit {
+    uint32_t start;
+    uint32_t oldEnd;
+    uint32_t newEnd;
+};
+
+struct ReparseResult {
+    bool incremental = false; // false: se lexeó y parseó todo
+    size_t relexedTokens = 0; // tokens producidos por el lexeo
+    size_t reusedItems = 0;   // items del Program que no se reparsearon
+};
+
+// Actualiza tokens y program para newSource (que debe seguir vivo
+// mientras se usen los tokens). Ante un error léxico o sintáctico
+// lanza runtime_error y deja tokens y program sin cambios.
+ReparseResult reparseEdit(const char* newSource, size_t newSize, const SourceEdit& edit,
+                          TokenBuffer& tokens, Program*& program);
+
+#endif // INCREMENTAL_H
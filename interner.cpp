@@ -0,0 +1,22 @@
+#include "interner.h"
+
+using namespace std;
+
+Interner::Interner() {
+    intern("");
+}
+
+SymbolId Interner::intern(string_view s) {
+    auto it = ids.find(s);
+    if (it != ids.end()) return it->second;
+
+    SymbolId id = static_cast<SymbolId>(names.size());
+    names.emplace_back(s);
+    ids.emplace(string_view(names.back()), id);
+    return id;
+}
+
+Interner& global_interner() {
+    static Interner interner;
+    return interner;
+}
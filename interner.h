@@ -0,0 +1,44 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+// ===========================================================
+//  Tabla global de identificadores internados.
+//  Cada nombre distinto recibe un id de 32 bits una sola vez
+//  (en el scanner); AST, tablas de símbolos y cache DAG usan
+//  ese id como clave en lugar del string.
+//  No es thread-safe: internar sólo desde un hilo a la vez.
+// ===========================================================
+
+typedef uint32_t SymbolId;
+
+class Interner {
+private:
+    deque<string> names;                        // almacenamiento estable
+    unordered_map<string_view, SymbolId> ids;   // vistas sobre names
+
+public:
+    Interner();
+
+    // Retorna el id de s, creándolo si no existía
+    SymbolId intern(string_view s);
+
+    // Nombre asociado a un id válido
+    const string& name(SymbolId id) const { return names[id]; }
+
+    size_t size() const { return names.size(); }
+};
+
+// El id 0 está reservado para el nombre vacío ("sin símbolo")
+const SymbolId kNoSymbol = 0;
+
+Interner& global_interner();
+
+#endif // INTERNER_H
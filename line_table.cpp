@@ -0,0 +1,71 @@
+#include <algorithm>
+#include "line_table.h"
+
+#if defined(__SSE2__) && !defined(SCANNER_NO_SIMD)
+#include <emmintrin.h>
+#define LINE_TABLE_USE_SSE2 1
+#endif
+
+using namespace std;
+
+// -----------------------------
+// Constructores
+// -----------------------------
+
+LineTable::LineTable() : source(nullptr), length(0), built(false) { }
+
+LineTable::LineTable(const char* src, size_t size) : source(src), length(size), built(false) { }
+
+void LineTable::reset(const char* src, size_t size) {
+    source = src;
+    length = size;
+    lineStarts.clear();
+    built = false;
+}
+
+// -----------------------------
+// Construcción del índice (una sola pasada)
+// -----------------------------
+
+void LineTable::build() const {
+    lineStarts.clear();
+    lineStarts.push_back(0);
+    size_t pos = 0;
+#ifdef LINE_TABLE_USE_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (pos + 16 <= length) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + pos));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            lineStarts.push_back(static_cast<uint32_t>(pos + bit + 1));
+            mask &= mask - 1;
+        }
+        pos += 16;
+    }
+#endif
+    for (; pos < length; ++pos) {
+        if (source[pos] == '\n') lineStarts.push_back(static_cast<uint32_t>(pos + 1));
+    }
+    built = true;
+}
+
+// -----------------------------
+// Consultas
+// -----------------------------
+
+SourceLocation LineTable::locate(uint32_t offset) const {
+    if (!built) build();
+    // Última línea cuyo inicio es <= offset
+    auto it = upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    size_t line = static_cast<size_t>(it - lineStarts.begin()); // >= 1 porque lineStarts[0] == 0
+    SourceLocation loc;
+    loc.line = static_cast<int>(line);
+    loc.column = static_cast<int>(offset - lineStarts[line - 1]) + 1;
+    return loc;
+}
+
+size_t LineTable::lineCount() const {
+    if (!built) build();
+    return lineStarts.size();
+}
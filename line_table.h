@@ -0,0 +1,43 @@
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Posición legible (ambas desde 1)
+struct SourceLocation {
+    int line;
+    int column;
+};
+
+// ===========================================================
+//  Índice de inicios de línea del buffer fuente.
+//  Tokens y nodos del AST guardan sólo un offset en bytes; la
+//  tabla se construye en una pasada (SSE2 cuando está disponible)
+//  la primera vez que alguien pide una posición, y cada consulta
+//  es una búsqueda binaria. El lexeo no paga nada por esto.
+// ===========================================================
+
+class LineTable {
+private:
+    const char* source;
+    size_t length;
+    mutable vector<uint32_t> lineStarts;
+    mutable bool built;
+
+    void build() const;
+
+public:
+    LineTable();
+    LineTable(const char* src, size_t size);
+
+    void reset(const char* src, size_t size);
+
+    SourceLocation locate(uint32_t offset) const;
+    size_t lineCount() const;
+};
+
+#endif // LINE_TABLE_H
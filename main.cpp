@@ -2,25 +2,50 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <thread>
+#include "source_buffer.h"
 #include "scanner.h"
 #include "parser.h"
 #include "ast.h"
 #include "visitor.h"
+#include "ast_cache.h"
 
 using namespace std;
 
+// Versión del compilador, para que quien lo invoque sepa qué flags acepta.
+//   1: compilador base (no reconoce --version)
+//   2: --ast-cache
+static const int kCompilerVersion = 2;
+
 int main(int argc, const char* argv[]) {
+    if (argc == 2 && string(argv[1]) == "--version") {
+        cout << "compiler " << kCompilerVersion << endl;
+        return 0;
+    }
+
     // Verificar número de argumentos
     if (argc < 2) {
-        cout << "Uso: " << argv[0] << " <archivo_de_entrada> [--no-opt] [--stats]" << endl;
-        cout << "  --no-opt  : Deshabilitar optimizaciones" << endl;
-        cout << "  --stats   : Mostrar estadísticas de optimización" << endl;
+        cout << "Uso: " << argv[0] << " --version | <archivo_de_entrada> [--no-opt] [--stats] [--source-lines] [--signatures] [--hash-cons] [--ast-cache dir] [--reorder-fields] [--layout-report]" << endl;
+        cout << "  --no-opt       : Deshabilitar optimizaciones" << endl;
+        cout << "  --stats        : Mostrar estadísticas de optimización" << endl;
+        cout << "  --source-lines : Anotar el assembly con la línea de origen de cada sentencia" << endl;
+        cout << "  --signatures   : Sólo listar structs, alias y firmas (sin parsear cuerpos)" << endl;
+        cout << "  --hash-cons    : Compartir subexpresiones puras idénticas en el AST" << endl;
+        cout << "  --ast-cache d  : Reusar el AST de un fuente idéntico guardado en el directorio d" << endl;
+        cout << "  --reorder-fields : Ubicar los campos de cada struct minimizando el padding" << endl;
+        cout << "  --layout-report  : Mostrar tamaño, alineación y padding de cada struct" << endl;
         return 1;
     }
 
     // Parsear argumentos
     bool enableOptimizations = true;
     bool showStats = false;
+    bool sourceLines = false;
+    bool signaturesOnly = false;
+    bool hashCons = false;
+    bool reorderFields = false;
+    bool layoutReport = false;
+    string astCacheDir;
     
     for (int i = 2; i < argc; i++) {
         string arg = argv[i];
@@ -28,29 +53,81 @@ int main(int argc, const char* argv[]) {
             enableOptimizations = false;
         } else if (arg == "--stats") {
             showStats = true;
+        } else if (arg == "--source-lines") {
+            sourceLines = true;
+        } else if (arg == "--signatures") {
+            signaturesOnly = true;
+        } else if (arg == "--hash-cons") {
+            hashCons = true;
+        } else if (arg == "--reorder-fields") {
+            reorderFields = true;
+        } else if (arg == "--layout-report") {
+            layoutReport = true;
+        } else if (arg == "--ast-cache" && i + 1 < argc) {
+            astCacheDir = argv[++i];
         }
     }
 
-    // Abrir archivo de entrada
-    ifstream infile(argv[1]);
-    if (!infile.is_open()) {
+    // Cargar archivo de entrada (mmap o una sola lectura, sin copias extra)
+    SourceBuffer source;
+    if (!source.open(argv[1])) {
         cout << "No se pudo abrir el archivo: " << argv[1] << endl;
         return 1;
     }
 
-    // Leer contenido completo del archivo en un string
-    string input, line;
-    while (getline(infile, line)) {
-        input += line + '\n';
-    }
-    infile.close();
+    // Con --ast-cache un fuente ya compilado no se lexea ni se parsea:
+    // el AST se lee del cache (ver ast_cache.h)
+    FlatAst cachedAst;
+    bool fromCache = !astCacheDir.empty() && !signaturesOnly &&
+                     AstCache(astCacheDir).load(source.data(), source.size(), cachedAst);
 
-    // Crear instancias de Scanner y Parser
-    Scanner scanner(input.c_str());
-    Parser parser(&scanner);
+    Program* program = nullptr;
+    if (fromCache) {
+        cout << "AST leído del cache" << endl;
+        program = cachedAst.materialize();
+    } else {
+        // Lexear todo el archivo a un buffer contiguo (en paralelo si es grande)
+        // y parsear sobre él
+        Scanner scanner(source.data(), source.size());
+        TokenBuffer tokens;
+        scanner.tokenizeParallel(tokens, thread::hardware_concurrency());
+        Parser parser(&tokens);
+        parser.setLazyBodies(signaturesOnly);
+        parser.setHashConsing(hashCons);
+
+        // Parsear y generar AST (cuerpos de funciones en paralelo si es grande)
+        program = signaturesOnly ? parser.parseProgram()
+                                 : parser.parseProgramParallel(thread::hardware_concurrency());
+
+        if (signaturesOnly) {
+            for (auto sd : program->sdlist) {
+                cout << "struct " << sd->name << " {";
+                for (size_t i = 0; i < sd->fields.size(); i++) {
+                    cout << (i ? ", " : " ") << sd->fields[i].first << ": " << sd->fields[i].second;
+                }
+                cout << " }" << endl;
+            }
+            for (auto ta : program->talist) {
+                cout << "type " << ta->alias << " = " << ta->type << ";" << endl;
+            }
+            for (auto cd : program->cdlist) {
+                cout << "const " << cd->name() << ": " << cd->tipo << ";" << endl;
+            }
+            for (auto fd : program->fdlist) {
+                cout << (fd->isConst ? "const fn " : "fn ") << fd->nombre << "(";
+                for (size_t i = 0; i < fd->Nparametros.size(); i++) {
+                    cout << (i ? ", " : "") << global_interner().name(fd->Nparametros[i]) << ": " << fd->Tparametros[i];
+                }
+                cout << ") -> " << fd->tipo << endl;
+            }
+            delete program;
+            return 0;
+        }
 
-    // Parsear y generar AST
-    Program* program = parser.parseProgram();
+        if (!astCacheDir.empty()) {
+            AstCache(astCacheDir).store(source.data(), source.size(), FlatAst::fromProgram(program));
+        }
+    }
     
     // Preparar archivo de salida
     string inputFile(argv[1]);
@@ -77,6 +154,12 @@ int main(int argc, const char* argv[]) {
     codigo.enableOptimizations(enableOptimizations);
     codigo.enableDAGOptimization(enableOptimizations);
     codigo.enablePeepholeOptimization(enableOptimizations);
+    codigo.setFieldReordering(reorderFields);
+
+    LineTable lineTable(source.data(), source.size());
+    if (sourceLines) {
+        codigo.setSourceLines(&lineTable);
+    }
     
     codigo.generar(program);
     outfile.close();
@@ -87,6 +170,11 @@ int main(int argc, const char* argv[]) {
         codigo.printOptimizationStats(cout);
     }
 
+    if (layoutReport) {
+        cout << "\n";
+        codigo.printLayoutReport(cout);
+    }
+
     cout << "\nCompilación exitosa!" << endl;
 
     delete program;
@@ -11,7 +11,7 @@
 // Este compilador implementa DOS optimizaciones:
 //
 // 1. DAG (Directed Acyclic Graph) - Eliminación de subexpresiones comunes
-//    ├── Ubicación: visitor.cpp (función generateExprSignature, lookupDAGCache, etc.)
+//    ├── Ubicación: visitor.cpp (lookupDAGCache, saveToDAGCache; clave Exp::hash)
 //    ├── Momento: Durante la generación de código
 //    └── Funcionamiento: Mantiene un cache de expresiones ya calculadas.
 //        Cuando encuentra "a + b" por segunda vez, reutiliza el valor guardado.
@@ -531,8 +531,8 @@ std::vector<std::string> CodeOptimizer::optimizeCode(
     }
     
     // NOTA: La optimización DAG se realiza en visitor.cpp durante
-    // la generación de código (ver funciones generateExprSignature,
-    // lookupDAGCache, saveToDAGCache en visitor.cpp)
+    // la generación de código (ver funciones lookupDAGCache,
+    // saveToDAGCache en visitor.cpp)
     
     stats.optimizedInstructions = result.size();
     return result;
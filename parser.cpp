@@ -1,6 +1,10 @@
 // Nuevo parser para gramática Rust simplificada (consumo + AST mínima)
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 #include "token.h"
 #include "scanner.h"
 #include "ast.h"
@@ -8,21 +12,40 @@
 
 using namespace std;
 
-Parser::Parser(Scanner* sc): scanner(sc), current(nullptr), previous(nullptr) {
+// Fija el offset de inicio de un nodo recién creado
+template <typename T>
+static T* at(uint32_t offset, T* node) {
+    node->offset = offset;
+    return node;
+}
+
+Parser::Parser(Scanner* sc): scanner(sc), tokens(nullptr), pos(0), discardSym(global_interner().intern("_")),
+    lines(sc->source(), sc->size()), arena(nullptr), lazyBodies(false), hashConsing(false) {
+    advance();
+}
+
+Parser::Parser(const TokenBuffer* buffer): scanner(nullptr), tokens(buffer), pos(0), discardSym(global_interner().intern("_")),
+    arena(nullptr), lazyBodies(false), hashConsing(false) {
+    if (tokens->empty()) throw runtime_error("Parser: buffer de tokens vacío");
+    lines.reset(tokens->source, tokens->offsets.back() + tokens->lengths.back());
     advance();
 }
 
 bool Parser::check(Token::Type t){
     if (isAtEnd()) return false;
-    return current->type == t;
+    return current.type == t;
 }
 
 void Parser::advance(){
-    if (previous) delete previous;
     previous = current;
-    current = scanner->nextToken();
-    if (current->type == Token::ERR){
-        throw runtime_error("Error léxico: token inválido '" + current->text + "'");
+    if (tokens) {
+        current = tokens->token(pos);
+        if (pos + 1 < tokens->size()) ++pos; // END se repite al final
+    } else {
+        current = scanner->nextToken();
+    }
+    if (current.type == Token::ERR){
+        throw runtime_error("Error léxico: token inválido '" + string(current.text) + "'");
     }
 }
 
@@ -31,20 +54,188 @@ bool Parser::match(Token::Type t){
     return false;
 }
 
-bool Parser::isAtEnd(){ return current && current->type == Token::END; }
+Token::Type Parser::peekType(size_t k){
+    if (k == 0) return current.type;
+    if (!tokens) throw runtime_error("Parser::peekType requiere modo pre-tokenizado");
+    size_t idx = pos + k - 1;
+    if (idx >= tokens->size()) return Token::END;
+    return tokens->kind(idx);
+}
+
+bool Parser::isAtEnd(){ return current.type == Token::END; }
 
 void Parser::consume(Token::Type t, const string& msg){
     if (!match(t)) throw runtime_error("Error sintáctico: se esperaba " + msg);
 }
 
+// Salta desde el '{' actual hasta su '}' mirando sólo los tipos del buffer,
+// sin reconstruir tokens ni crear nodos
+size_t Parser::skipBlock(){
+    size_t n = tokens->size();
+    size_t depth = 0;
+    size_t i = pos - 1; // current es tokens->token(pos - 1)
+    for (; i < n; ++i) {
+        Token::Type k = tokens->kind(i);
+        if (k == Token::LBRACE) ++depth;
+        else if (k == Token::RBRACE) { if (--depth == 0) break; }
+        else if (k == Token::END || k == Token::ERR) break;
+    }
+    // Queda en el '}' (o en END/ERR, que reportan su propio error)
+    pos = i < n ? i : n - 1;
+    advance();
+    consume(Token::RBRACE, "'}' bloque");
+    return i;
+}
+
+string Parser::withLocation(const string& msg){
+    SourceLocation loc = locate(current.offset);
+    return msg + " (línea " + to_string(loc.line) + ", columna " + to_string(loc.column) + ")";
+}
+
+void Parser::setLazyBodies(bool lazy){
+    if (lazy && !tokens) throw runtime_error("Parser: los cuerpos diferidos requieren modo pre-tokenizado");
+    lazyBodies = lazy;
+}
+
+Body* Parser::parseBody(Program* p, FunDec* fd){
+    return parseBodyInto(&p->arena, fd);
+}
+
+Body* Parser::parseBodyInto(Arena* into, FunDec* fd){
+    if (fd->cuerpo) return fd->cuerpo;
+    if (!tokens) throw runtime_error("Parser::parseBody requiere modo pre-tokenizado");
+    // Se reparsea el rango guardado y luego se restaura la posición
+    size_t savedPos = pos;
+    Token savedCurrent = current, savedPrevious = previous;
+    Arena* savedArena = arena;
+    arena = into;
+    expTable.clear();
+    pos = fd->bodyBegin;
+    try {
+        advance();
+        BlockStm* bodyBlock = parseBlock();
+        fd->cuerpo = make<Body>();
+        fd->cuerpo->stmlist.push_back(bodyBlock);
+    } catch (const runtime_error& e) {
+        string msg = withLocation(e.what());
+        pos = savedPos; current = savedCurrent; previous = savedPrevious; arena = savedArena;
+        throw runtime_error(msg);
+    }
+    pos = savedPos; current = savedCurrent; previous = savedPrevious; arena = savedArena;
+    return fd->cuerpo;
+}
+
+void Parser::parseAllBodies(Program* p){
+    for (FunDec* fd : p->fdlist) parseBody(p, fd);
+}
+
+Parser::Item Parser::parseItemAt(Program* p, size_t index, size_t& end){
+    if (!tokens) throw runtime_error("Parser::parseItemAt requiere modo pre-tokenizado");
+    Arena* savedArena = arena;
+    arena = &p->arena;
+    pos = index;
+    Item item;
+    try {
+        advance();
+        if (check(Token::FN)) item.function = parseFunction();
+        else if (check(Token::STRUCT)) item.structDec = parseStruct();
+        else if (check(Token::TYPE)) item.alias = parseTypeAlias();
+        else if (check(Token::CONST)) item = parseConstItem();
+        else throw runtime_error("Error sintáctico: se esperaba 'fn', 'struct', 'type' o 'const'");
+    } catch (const runtime_error& e) {
+        arena = savedArena;
+        throw runtime_error(withLocation(e.what()));
+    }
+    arena = savedArena;
+    // END se repite al final: pos no avanza al leer el último token
+    end = current.type == Token::END ? tokens->size() - 1 : pos - 1;
+    return item;
+}
+
+// Por debajo de este tamaño crear hilos cuesta más que parsear
+static const size_t kParallelMinTokens = 1 << 16;
+
+Program* Parser::parseProgramParallel(unsigned threads){
+    if (!tokens) throw runtime_error("Parser: el parseo paralelo requiere modo pre-tokenizado");
+    if (threads <= 1 || tokens->size() < kParallelMinTokens) return parseProgram();
+
+    // Fronteras de los items: firmas completas, cuerpos saltados por llaves
+    bool savedLazy = lazyBodies;
+    lazyBodies = true;
+    Program* p = nullptr;
+    try {
+        p = parseProgramQuiet();
+    } catch (...) {
+        lazyBodies = savedLazy;
+        throw;
+    }
+    lazyBodies = savedLazy;
+
+    const vector<FunDec*>& funcs = p->fdlist;
+    size_t workerCount = min<size_t>(threads, funcs.size());
+    // Un Parser y una arena por hilo, creados aquí: el constructor interna
+    // "_" y ni el interner ni la arena son thread-safe
+    deque<Parser> parsers;
+    deque<Arena> arenas;
+    for (size_t w = 0; w < workerCount; ++w) {
+        parsers.emplace_back(tokens);
+        parsers.back().setHashConsing(hashConsing);
+        arenas.emplace_back();
+    }
+    vector<string> errors(funcs.size());
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    workers.reserve(workerCount);
+    for (size_t w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&, w]() {
+            // Cada hilo toma la siguiente función pendiente
+            for (size_t i = next++; i < funcs.size(); i = next++) {
+                try {
+                    parsers[w].parseBodyInto(&arenas[w], funcs[i]);
+                } catch (const runtime_error& e) {
+                    errors[i] = e.what();
+                }
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    for (auto& a : arenas) p->arena.absorb(a);
+    // Se reporta el primer error de cuerpo en orden de fuente; el éxito,
+    // recién cuando todos los cuerpos parsearon
+    for (auto& e : errors) {
+        if (!e.empty()) {
+            delete p;
+            throw runtime_error(e);
+        }
+    }
+    cout << "Parseo exitoso" << endl;
+    return p;
+}
+
 Program* Parser::parseProgram(){
-    Program* p = new Program();
-    parseItems(p);
-    if (!isAtEnd()) throw runtime_error("Error sintáctico: tokens restantes tras parseo");
+    Program* p = parseProgramQuiet();
     cout << "Parseo exitoso" << endl;
     return p;
 }
 
+Program* Parser::parseProgramQuiet(){
+    Program* p = new Program();
+    p->sharedExps = hashConsing;
+    arena = &p->arena;
+    try {
+        parseItems(p);
+        if (!isAtEnd()) throw runtime_error("Error sintáctico: tokens restantes tras parseo");
+    } catch (const runtime_error& e) {
+        // El árbol parcial se libera junto con su arena
+        delete p;
+        arena = nullptr;
+        // Todos los errores se reportan en la posición del token actual
+        throw runtime_error(withLocation(e.what()));
+    }
+    return p;
+}
+
 void Parser::parseItems(Program* p){
     while(!isAtEnd()){
         // Mirar posibles comienzos de Item
@@ -54,6 +245,10 @@ void Parser::parseItems(Program* p){
             p->sdlist.push_back(parseStruct());
         } else if (check(Token::TYPE)) {
             p->talist.push_back(parseTypeAlias());
+        } else if (check(Token::CONST)) {
+            Item item = parseConstItem();
+            if (item.function) p->fdlist.push_back(item.function);
+            else p->cdlist.push_back(item.constDec);
         } else {
             // En Rust top-level sólo se permiten estos en nuestra gramática
             break;
@@ -62,29 +257,30 @@ void Parser::parseItems(Program* p){
 }
 
 FunDec* Parser::parseFunction(){
+    uint32_t start = current.offset;
     consume(Token::FN, "'fn'");
     consume(Token::IDENTIFIER, "nombre de función");
-    string nombre = previous->text;
+    string nombre(previous.text);
     consume(Token::LPAREN, "'('");
     // ParamListOpt
-    vector<string> paramN;
+    vector<SymbolId> paramN;
     vector<string> paramT;
     if (check(Token::IDENTIFIER)){
         // Param: IDENTIFIER ':' Type
         consume(Token::IDENTIFIER, "param nombre");
-        string pname = previous->text;
+        SymbolId pname = previous.sym;
         consume(Token::COLON, ":");
         // Type (simplificado: consumimos primer token que puede iniciar Type)
         if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
             paramN.push_back(pname);
-            paramT.push_back(previous->text);
+            paramT.emplace_back(previous.text);
             while(match(Token::COMMA)){
                 consume(Token::IDENTIFIER, "param nombre");
-                pname = previous->text;
+                pname = previous.sym;
                 consume(Token::COLON, ":");
                 if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
                     paramN.push_back(pname);
-                    paramT.push_back(previous->text);
+                    paramT.emplace_back(previous.text);
                 } else throw runtime_error("Tipo esperado en parámetro");
             }
         } else throw runtime_error("Tipo de primer parámetro esperado");
@@ -94,41 +290,47 @@ FunDec* Parser::parseFunction(){
     string retType = "void";
     if (match(Token::ARROW)){
         if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)){
-            retType = previous->text;
+            retType = string(previous.text);
         } else throw runtime_error("Tipo de retorno esperado tras '->'");
     }
-    // Block
-    BlockStm* bodyBlock = parseBlock();
-    // Construir FunDec con cuerpo real
-    FunDec* fd = new FunDec();
+    FunDec* fd = at(start, make<FunDec>());
     fd->nombre = nombre;
     fd->tipo = retType;
     fd->Nparametros = paramN;
     fd->Tparametros = paramT;
-    fd->cuerpo = new Body();
+    // Block: diferido (sólo el rango de tokens) o construido ahora
+    if (lazyBodies) {
+        if (!check(Token::LBRACE)) consume(Token::LBRACE, "'{' bloque");
+        fd->bodyBegin = static_cast<uint32_t>(pos - 1);
+        fd->bodyEnd = static_cast<uint32_t>(skipBlock());
+        return fd;
+    }
+    expTable.clear(); // se comparte dentro de cada función (como el cache de CSE)
+    BlockStm* bodyBlock = parseBlock();
+    fd->cuerpo = make<Body>();
     fd->cuerpo->stmlist.push_back(bodyBlock);
     return fd;
 }
 
 StructDec* Parser::parseStruct(){
+    uint32_t start = current.offset;
     consume(Token::STRUCT, "'struct'");
     consume(Token::IDENTIFIER, "nombre de struct");
-    string structName = previous->text;
-    StructDec* sd = new StructDec(structName);
+    string structName(previous.text);
+    StructDec* sd = at(start, make<StructDec>(structName));
     consume(Token::LBRACE, "'{' struct");
     // Campos: IDENT ':' Type ';'
     while(check(Token::IDENTIFIER)){
         advance(); // nombre campo
-        string fieldName = previous->text;
+        string fieldName(previous.text);
         consume(Token::COLON, ": en campo struct");
         // Type simplificada
         string fieldType;
         if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
-            fieldType = previous->text;
+            fieldType = string(previous.text);
             // ArrayType opcional
             if (match(Token::LBRACKET)){
-                string size = current->text;
-                consume(Token::NUMBER, "tamaño array en campo struct");
+                string size = parseArrayLength();
                 consume(Token::RBRACKET, "]");
                 fieldType += "[" + size + "]";
             }
@@ -141,32 +343,64 @@ StructDec* Parser::parseStruct(){
 }
 
 TypeAlias* Parser::parseTypeAlias(){
+    uint32_t start = current.offset;
     consume(Token::TYPE, "'type'");
     consume(Token::IDENTIFIER, "nombre alias");
-    string alias = previous->text;
+    string alias(previous.text);
     consume(Token::ASSIGN, "'=' en alias de tipo");
     // Type
     string typeName;
     if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
-        typeName = previous->text;
+        typeName = string(previous.text);
         if (match(Token::LBRACKET)){
-            consume(Token::NUMBER, "tamaño de array");
-            typeName += "[" + previous->text + "]";
+            typeName += "[" + parseArrayLength() + "]";
             consume(Token::RBRACKET, "]");
         }
     } else throw runtime_error("Tipo esperado en alias");
     consume(Token::SEMICOL, "; final alias");
-    return new TypeAlias(alias, typeName);
+    return at(start, make<TypeAlias>(alias, typeName));
+}
+
+Parser::Item Parser::parseConstItem(){
+    uint32_t start = current.offset;
+    consume(Token::CONST, "'const'");
+    Item item;
+    if (check(Token::FN)) {
+        item.function = parseFunction();
+        item.function->isConst = true;
+        item.function->offset = start;
+        return item;
+    }
+    consume(Token::IDENTIFIER, "nombre de constante");
+    SymbolId name = previous.sym;
+    consume(Token::COLON, ": en constante");
+    string typeName;
+    if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
+        typeName = string(previous.text);
+    } else throw runtime_error("Tipo esperado en constante");
+    consume(Token::ASSIGN, "'=' en constante");
+    expTable.clear(); // el inicializador no comparte nodos con la función anterior
+    Exp* init = parseExpression();
+    consume(Token::SEMICOL, "; final constante");
+    item.constDec = at(start, make<ConstDec>(name, typeName, init));
+    return item;
+}
+
+string Parser::parseArrayLength(){
+    if (match(Token::NUMBER) || match(Token::IDENTIFIER)) return string(previous.text);
+    throw runtime_error("Error sintáctico: se esperaba tamaño de array (número o constante)");
 }
 
 BlockStm* Parser::parseBlock(){
-    BlockStm* block = new BlockStm();
+    BlockStm* block = at(current.offset, make<BlockStm>());
     consume(Token::LBRACE, "'{' bloque");
+    size_t scope = expTable.openScope();
     while(!check(Token::RBRACE) && !isAtEnd()){
         Stm* s = parseStatement();
         if (s) block->statements.push_back(s);
     }
     consume(Token::RBRACE, "'}' bloque");
+    if (hashConsing) expTable.closeScope(scope);
     return block;
 }
 
@@ -180,10 +414,10 @@ Stm* Parser::parseStatement(){
     if (check(Token::LBRACE)) return parseBlock();
     // ExpressionStmt
     Exp* e = parseExpression();
-    if (match(Token::SEMICOL)) return new AssignStm("_", e); // placeholder simple
+    if (match(Token::SEMICOL)) return at(e->offset, make<AssignStm>(discardSym, e)); // placeholder simple
     // Permitir expresión final de bloque como retorno implícito
     if (check(Token::RBRACE)) {
-        ReturnStm* r = new ReturnStm();
+        ReturnStm* r = at(e->offset, make<ReturnStm>());
         r->e = e;
         return r;
     }
@@ -191,32 +425,36 @@ Stm* Parser::parseStatement(){
 }
 
 LetStm* Parser::parseVarDecl(){
+    uint32_t start = current.offset;
     consume(Token::LET, "'let'");
     bool mut = match(Token::MUT);
     consume(Token::IDENTIFIER, "nombre variable");
-    string varName = previous->text;
+    SymbolId varName = previous.sym;
     consume(Token::COLON, ": en declaración");
     // Type (guardamos solo como texto simple por ahora)
     string typeName;
     if (match(Token::IDENTIFIER) || match(Token::I32) || match(Token::I64) || match(Token::U32) || match(Token::U64) || match(Token::F32) || match(Token::F64) || match(Token::BOOL)) {
-        typeName = previous->text;
+        typeName = string(previous.text);
         if (match(Token::LBRACKET)) { 
-            string size = current->text;
-            consume(Token::NUMBER, "tamaño array"); 
+            string size = parseArrayLength();
             consume(Token::RBRACKET, "]"); 
             typeName += "[" + size + "]";
         }
     } else throw runtime_error("Tipo esperado en declaración");
+    // El checker y el codegen declaran la variable antes de visitar el init:
+    // el init ya no comparte sus IdExp con los usos del binding anterior
+    if (hashConsing) expTable.bind(varName);
     // OptAssign
     Exp* init = nullptr;
     if (match(Token::ASSIGN)) {
         init = parseExpression();
     }
     consume(Token::SEMICOL, "; final declaración");
-    return new LetStm(mut, varName, typeName, init);
+    return at(start, make<LetStm>(mut, varName, typeName, init));
 }
 
 IfStm* Parser::parseIf(){
+    uint32_t start = current.offset;
     consume(Token::IF, "'if'");
     Exp* cond = nullptr;
     if (match(Token::LPAREN)){
@@ -227,34 +465,39 @@ IfStm* Parser::parseIf(){
     BlockStm* thenB = parseBlock();
     BlockStm* elseB = nullptr;
     if (match(Token::ELSE)) { elseB = parseBlock(); }
-    return new IfStm(cond, thenB, elseB);
+    return at(start, make<IfStm>(cond, thenB, elseB));
 }
 
 WhileStm* Parser::parseWhile(){
+    uint32_t start = current.offset;
     consume(Token::WHILE, "'while'");
     Exp* cond = nullptr;
     if (match(Token::LPAREN)){
         cond = parseExpression(); consume(Token::RPAREN, ") en while");
     } else { cond = parseExpression(); }
     BlockStm* body = parseBlock();
-    return new WhileStm(cond, body);
+    return at(start, make<WhileStm>(cond, body));
 }
 
 ForStm* Parser::parseFor(){
+    uint32_t forStart = current.offset;
     consume(Token::FOR, "'for'");
     consume(Token::IDENTIFIER, "iterador for");
-    string it = previous->text;
+    SymbolId it = previous.sym;
     consume(Token::IN, "'in' en for");
     Exp* start = parseExpression();
     consume(Token::DOTDOT, "'..' rango for");
     Exp* end = parseExpression();
+    size_t scope = expTable.openScope();
+    if (hashConsing) expTable.bind(it);
     BlockStm* body = parseBlock();
-    return new ForStm(it, start, end, body);
+    if (hashConsing) expTable.closeScope(scope);
+    return at(forStart, make<ForStm>(it, start, end, body));
 }
 
 ReturnStm* Parser::parseReturn(){
+    ReturnStm* r = at(current.offset, make<ReturnStm>());
     consume(Token::RETURN, "'return'");
-    ReturnStm* r = new ReturnStm();
     // ExpressionOpt
     if (!check(Token::SEMICOL)) { r->e = parseExpression(); }
     consume(Token::SEMICOL, "; en return");
@@ -262,6 +505,7 @@ ReturnStm* Parser::parseReturn(){
 }
 
 PrintStm* Parser::parsePrint(){
+    uint32_t start = current.offset;
     consume(Token::PRINTLN, "'println!'");
     consume(Token::LPAREN, "'(' en println");
     // STRING_LITERAL opcional seguido de , lista de expresiones
@@ -275,90 +519,85 @@ PrintStm* Parser::parsePrint(){
     }
     consume(Token::RPAREN, ") en println");
     consume(Token::SEMICOL, "; en println");
-    return new PrintStm(firstExpr);
+    return at(start, make<PrintStm>(firstExpr));
 }
 
 // =====================
 // Expresiones
 // =====================
+
+namespace {
+// Precedencia y operador del AST para cada token binario, indexado por
+// Token::Type (prec 0 = no es operador binario). Mayor liga más fuerte.
+struct BinaryOpInfo {
+    uint8_t prec;
+    BinaryOp op;
+};
+
+struct BinaryOpTable {
+    BinaryOpInfo info[Token::AND_LEGACY + 1];
+
+    BinaryOpTable() : info() {
+        info[Token::OR]  = {1, AND_OP}; // '||' genera AND_OP, como el parser anterior
+        info[Token::AND] = {2, AND_OP};
+        info[Token::EQ]  = {3, EQ_OP};
+        info[Token::NEQ] = {3, NEQ_OP};
+        info[Token::LT]  = {3, LT_OP};
+        info[Token::GT]  = {3, GT_OP};
+        info[Token::LE]  = {3, LE_OP};
+        info[Token::GE]  = {3, GE_OP};
+        info[Token::PLUS]  = {4, PLUS_OP};
+        info[Token::MINUS] = {4, MINUS_OP};
+        info[Token::MUL] = {5, MUL_OP};
+        info[Token::DIV] = {5, DIV_OP};
+    }
+};
+
+const BinaryOpTable kBinaryOps;
+}
+
 Exp* Parser::parseExpression(){ return parseAssignment(); }
 
 Exp* Parser::parseAssignment(){
-    Exp* left = parseOr();
+    Exp* left = parseBinary(1);
     if (match(Token::ASSIGN)){
         Exp* right = parseAssignment();
-        return new BinaryExp(left, right, ASSIGN_OP);
+        return make<BinaryExp>(left, right, ASSIGN_OP);
     }
     if (match(Token::PLUS_ASSIGN)){
         Exp* right = parseAssignment();
-        IdExp* idLeft = dynamic_cast<IdExp*>(left);
+        IdExp* idLeft = as<IdExp>(left);
         if (idLeft) {
-            Exp* copyLeft = new IdExp(idLeft->value);
-            Exp* addExp = new BinaryExp(copyLeft, right, PLUS_OP);
-            return new BinaryExp(left, addExp, ASSIGN_OP);
+            Exp* copyLeft = at(idLeft->offset, make<IdExp>(idLeft->sym));
+            Exp* addExp = make<BinaryExp>(copyLeft, right, PLUS_OP);
+            return make<BinaryExp>(left, addExp, ASSIGN_OP);
         }
         throw runtime_error("Compound assignment += requires identifier on left side");
     }
     if (match(Token::MINUS_ASSIGN)){
         Exp* right = parseAssignment();
-        IdExp* idLeft = dynamic_cast<IdExp*>(left);
+        IdExp* idLeft = as<IdExp>(left);
         if (idLeft) {
-            Exp* copyLeft = new IdExp(idLeft->value);
-            Exp* subExp = new BinaryExp(copyLeft, right, MINUS_OP);
-            return new BinaryExp(left, subExp, ASSIGN_OP);
+            Exp* copyLeft = at(idLeft->offset, make<IdExp>(idLeft->sym));
+            Exp* subExp = make<BinaryExp>(copyLeft, right, MINUS_OP);
+            return make<BinaryExp>(left, subExp, ASSIGN_OP);
         }
         throw runtime_error("Compound assignment -= requires identifier on left side");
     }
     return left;
 }
 
-Exp* Parser::parseOr(){
-    Exp* left = parseAnd();
-    while (match(Token::OR)) { Exp* right = parseAnd(); left = new BinaryExp(left, right, AND_OP); }
-    return left;
-}
-
-Exp* Parser::parseAnd(){
-    Exp* left = parseRel();
-    while (match(Token::AND)) { Exp* right = parseRel(); left = new BinaryExp(left, right, AND_OP); }
-    return left;
-}
-
-Exp* Parser::parseRel(){
-    Exp* left = parseAdd();
-    while (match(Token::EQ) || match(Token::NEQ) || match(Token::LT) || match(Token::GT) || match(Token::LE) || match(Token::GE)) {
-        BinaryOp op;
-        switch(previous->type){
-            case Token::EQ: op = EQ_OP; break;
-            case Token::NEQ: op = NEQ_OP; break;
-            case Token::LT: op = LT_OP; break;
-            case Token::GT: op = GT_OP; break;
-            case Token::LE: op = LE_OP; break;
-            case Token::GE: op = GE_OP; break;
-            default: op = LE_OP; break;
-        }
-        Exp* right = parseAdd(); 
-        left = new BinaryExp(left, right, op); 
-    }
-    return left;
-}
-
-Exp* Parser::parseAdd(){
-    Exp* left = parseMul();
-    while (match(Token::PLUS) || match(Token::MINUS)) { 
-        BinaryOp op = (previous->type == Token::PLUS) ? PLUS_OP : MINUS_OP;
-        Exp* right = parseMul(); 
-        left = new BinaryExp(left, right, op); 
-    }
-    return left;
-}
-
-Exp* Parser::parseMul(){
+// Precedence climbing: un solo bucle para todos los operadores binarios.
+// minPrec es la precedencia mínima que puede consumir este nivel; el lado
+// derecho se parsea con prec + 1, así todos asocian a la izquierda.
+Exp* Parser::parseBinary(int minPrec){
     Exp* left = parseUnary();
-    while (match(Token::MUL) || match(Token::DIV)) { 
-        BinaryOp op = (previous->type == Token::MUL) ? MUL_OP : DIV_OP;
-        Exp* right = parseUnary(); 
-        left = new BinaryExp(left, right, op); 
+    while (true) {
+        const BinaryOpInfo& info = kBinaryOps.info[current.type];
+        if (info.prec < minPrec) break; // prec 0: no es operador binario
+        advance();
+        Exp* right = parseBinary(info.prec + 1);
+        left = makeShared<BinaryExp>(left->offset, left, right, info.op);
     }
     return left;
 }
@@ -369,46 +608,25 @@ Exp* Parser::parseUnary(){
 }
 
 Exp* Parser::parsePostfix(){
+    uint32_t start = current.offset; // el IdExp puede ser compartido: su offset no sirve
     Exp* primary = parsePrimary();
     while (true){
         if (match(Token::DOT)) { 
             consume(Token::IDENTIFIER, "identificador tras '.'"); 
-            primary = new FieldAccessExp(primary, previous->text);
+            primary = make<FieldAccessExp>(primary, string(previous.text));
             continue; 
         }
         if (match(Token::LBRACKET)) { 
             Exp* index = parseExpression(); 
             consume(Token::RBRACKET, "] en indexación"); 
-            primary = new ArrayAccessExp(primary, index);
+            primary = make<ArrayAccessExp>(primary, index);
             continue; 
         }
         if (match(Token::LPAREN)) {
-            FcallExp* fcall = new FcallExp();
-            if (IdExp* id = dynamic_cast<IdExp*>(primary)) {
-                fcall->nombre = id->value;
-                // Don't delete primary here if we casted it? 
-                // Actually we are replacing 'primary' pointer with 'fcall'.
-                // The 'id' pointer points to the same memory.
-                // We should NOT delete 'id' yet if we want to use its value, but we copied the value.
-                // But 'primary' was allocated with 'new IdExp'. We should delete it to avoid leak, 
-                // BUT 'fcall' is the new primary.
-                // Wait, 'primary' is the 'IdExp'. We extract the name. Then we can delete 'primary'.
-                // But 'id' is just a casted pointer to 'primary'.
-                // So:
-                // string name = id->value;
-                // delete primary; 
-                // fcall->nombre = name;
-                // But wait, IdExp destructor might be virtual? Exp has virtual destructor.
-                // Yes.
-            } else {
-                throw runtime_error("Llamada a función requiere identificador");
-            }
-            
-            // We need to be careful. If we delete primary, 'id' becomes invalid?
-            // Yes. So extract name first.
-            string funcName = ((IdExp*)primary)->value;
-            delete primary;
-            fcall->nombre = funcName;
+            IdExp* id = as<IdExp>(primary);
+            if (!id) throw runtime_error("Llamada a función requiere identificador");
+            FcallExp* fcall = at(start, make<FcallExp>());
+            fcall->sym = id->sym;
 
             if (!check(Token::RPAREN)) {
                 fcall->argumentos.push_back(parseExpression());
@@ -422,18 +640,21 @@ Exp* Parser::parsePostfix(){
         }
         if (check(Token::LBRACE)) {
             // Struct initialization: Point { x: 1, y: 2 }
-            // primary must be IdExp
-            if (IdExp* id = dynamic_cast<IdExp*>(primary)) {
+            // primary must be IdExp. Con el buffer se mira si sigue `}` o
+            // `campo:`; si no, el '{' abre el bloque de un for/if/while (0..N {)
+            bool structBody = !tokens || peekType(1) == Token::RBRACE ||
+                              (peekType(1) == Token::IDENTIFIER && peekType(2) == Token::COLON);
+            IdExp* id = as<IdExp>(primary);
+            if (id && structBody) {
                 advance(); // Consume LBRACE
-                StructInitExp* sinit = new StructInitExp("");
-                sinit->name = id->value;
-                delete primary;
+                StructInitExp* sinit = at(start, make<StructInitExp>(""));
+                sinit->name = id->value();
                 
                 // Parse fields: ident : expr , ...
                 if (!check(Token::RBRACE)) {
                     do {
                         consume(Token::IDENTIFIER, "nombre campo struct");
-                        string fieldName = previous->text;
+                        string fieldName(previous.text);
                         consume(Token::COLON, ": en campo struct");
                         Exp* val = parseExpression();
                         sinit->fields.push_back({fieldName, val});
@@ -452,17 +673,16 @@ Exp* Parser::parsePostfix(){
 
 Exp* Parser::parsePrimary(){
     if (match(Token::NUMBER)) {
-        string text = previous->text;
+        string text(previous.text);
         if (text.find('.') != string::npos) {
-            return new FloatExp(stod(text), true); // Default to double/f64 for literals
+            return at(previous.offset, make<FloatExp>(stod(text), true)); // Default to double/f64 for literals
         }
-        return new NumberExp(stoll(text));
+        return makeShared<NumberExp>(previous.offset, stoll(text));
     }
-    if (match(Token::TRUE)) { BoolExp* b = new BoolExp(); b->valor = 1; return b; }
-    if (match(Token::FALSE)) { BoolExp* b = new BoolExp(); b->valor = 0; return b; }
+    if (match(Token::TRUE)) return makeShared<BoolExp>(previous.offset, 1);
+    if (match(Token::FALSE)) return makeShared<BoolExp>(previous.offset, 0);
     if (match(Token::IDENTIFIER)) {
-        string name = previous->text;
-        return new IdExp(name);
+        return makeShared<IdExp>(previous.offset, previous.sym);
     }
     if (match(Token::LPAREN)) { Exp* e = parseExpression(); consume(Token::RPAREN, ") cierre"); return e; }
     throw runtime_error("Expresión primaria inesperada");
@@ -3,12 +3,38 @@
 
 #include "scanner.h"
 #include "ast.h"
+#include "line_table.h"
 
 class Parser {
 private:
     Scanner* scanner;
-    Token* current;
-    Token* previous;
+    const TokenBuffer* tokens; // modo pre-tokenizado (scanner == nullptr)
+    size_t pos;                // índice del token siguiente a current en tokens
+    Token current;   // tokens por valor: sin new/delete por token
+    Token previous;
+    SymbolId discardSym; // "_": destino de sentencias de expresión
+    LineTable lines;     // sólo se construye si se pide una posición (errores)
+    Arena* arena;        // arena del Program en construcción
+    bool lazyBodies;     // sólo firmas: los cuerpos se parsean con parseBody
+    bool hashConsing;    // expresiones puras compartidas vía expTable
+    ExpTable expTable;
+
+    // Todos los nodos se crean en la arena del programa (sin delete)
+    template <typename T, typename... Args>
+    T* make(Args&&... args) { return arena->make<T>(std::forward<Args>(args)...); }
+    // Expresión pura en offset: con hash-consing se busca primero un nodo
+    // igual (sonda en la pila) y sólo si no existe se crea en la arena
+    template <typename T, typename... Args>
+    Exp* makeShared(uint32_t offset, Args... args) {
+        if (hashConsing) {
+            T probe(args...);
+            if (Exp* found = expTable.find(&probe)) return found;
+        }
+        T* node = make<T>(args...);
+        node->offset = offset;
+        if (hashConsing) expTable.insert(node);
+        return node;
+    }
 
     // utilidades
     bool match(Token::Type t);
@@ -16,6 +42,11 @@ private:
     void advance();
     bool isAtEnd();
     void consume(Token::Type t, const string& msg);
+    Token::Type peekType(size_t k); // k tokens después de current (sólo modo buffer)
+    size_t skipBlock();             // salta un bloque por llaves; retorna el índice del '}'
+    string withLocation(const string& msg); // agrega línea/columna del token actual
+    Body* parseBodyInto(Arena* into, FunDec* fd);
+    Program* parseProgramQuiet(); // parseProgram sin el mensaje de éxito
 
     // producciones principales
     void parseItems(Program* p);
@@ -23,6 +54,7 @@ private:
     FunDec* parseFunction();
     StructDec* parseStruct(); 
     TypeAlias* parseTypeAlias(); // placeholder
+    string parseArrayLength();    // N de T[N]: literal o nombre de una constante
 
     // statements / bloques
     BlockStm* parseBlock();
@@ -37,18 +69,48 @@ private:
     // expresiones
     Exp* parseExpression();
     Exp* parseAssignment();
-    Exp* parseOr();
-    Exp* parseAnd();
-    Exp* parseRel();
-    Exp* parseAdd();
-    Exp* parseMul();
+    Exp* parseBinary(int minPrec); // todos los operadores binarios (tabla de precedencias)
     Exp* parseUnary();
     Exp* parsePostfix();
     Exp* parsePrimary();
 
 public:
     Parser(Scanner* sc);
+    Parser(const TokenBuffer* buffer);
     Program* parseProgram();
+
+    // Cuerpos diferidos (sólo modo pre-tokenizado): con lazy, parseFunction
+    // guarda el rango de tokens del cuerpo y deja cuerpo == nullptr
+    void setLazyBodies(bool lazy);
+    Body* parseBody(Program* p, FunDec* fd); // construye el cuerpo si falta
+    void parseAllBodies(Program* p);
+
+    // Deduplica subárboles puros idénticos (el AST pasa a ser un DAG)
+    void setHashConsing(bool enable) { hashConsing = enable; }
+    size_t sharedExpressions() const { return expTable.reused(); }
+
+    // Firmas en este hilo y cuerpos de funciones repartidos entre threads
+    // hilos (sólo modo pre-tokenizado); el Program queda en orden de fuente
+    Program* parseProgramParallel(unsigned threads);
+
+    // Un item top-level (sólo uno de los punteros es no nulo)
+    struct Item {
+        FunDec* function = nullptr;
+        StructDec* structDec = nullptr;
+        TypeAlias* alias = nullptr;
+        ConstDec* constDec = nullptr;
+    };
+
+    // Parsea sólo el item que empieza en el token index (modo pre-tokenizado).
+    // El nodo se crea en la arena de p pero no se agrega a sus listas; end
+    // recibe el índice del primer token que sigue al item.
+    Item parseItemAt(Program* p, size_t index, size_t& end);
+
+    // Línea/columna de un offset del fuente (construye la tabla la primera vez)
+    SourceLocation locate(uint32_t offset) const { return lines.locate(offset); }
+
+private:
+    Item parseConstItem(); // const NAME: T = expr; o const fn
 };
 
 #endif // PARSER_H      
\ No newline at end of file
@@ -5,16 +5,25 @@ import shutil
 # Archivos c++
 programa = [
     "main.cpp",
+    "source_buffer.cpp",
+    "interner.cpp",
+    "arena.cpp",
+    "flat_ast.cpp",
+    "line_table.cpp",
     "scanner.cpp",
     "token.cpp",
     "parser.cpp",
     "ast.cpp",
     "visitor.cpp",
-    "optimizer.cpp"
+    "optimizer.cpp",
+    "ast_cache.cpp",
+    "incremental.cpp",
+    "type_table.cpp",
+    "const_eval.cpp"
 ]
 
 # Compilar
-compile = ["g++"] + programa
+compile = ["g++", "-pthread"] + programa
 print("Compilando:", " ".join(compile))
 result = subprocess.run(compile, capture_output=True, text=True)
 
@@ -31,7 +40,7 @@ os.makedirs(output_dir, exist_ok=True)
 
 binary = "a.exe" if os.name == "nt" else "./a.out"
 
-for i in range(1, 22):
+for i in range(1, 23):
     filename = f"input{i}.txt"
     filepath = os.path.join(input_dir, filename)
 
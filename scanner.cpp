@@ -1,15 +1,27 @@
 #include <iostream>
 #include <cstring>
 #include <fstream>
+#include <thread>
+#include <vector>
 #include "token.h"
 #include "scanner.h"
 
+// Rutas rápidas SSE2 (x86-64 base). Compilar con -DSCANNER_NO_SIMD
+// fuerza la ruta escalar, que produce exactamente los mismos tokens.
+#if defined(__SSE2__) && !defined(SCANNER_NO_SIMD)
+#include <emmintrin.h>
+#define SCANNER_USE_SSE2 1
+#endif
+
 using namespace std;
 
 // -----------------------------
 // Constructor
 // -----------------------------
-Scanner::Scanner(const char* s): input(s), first(0), current(0) { 
+Scanner::Scanner(const char* s): input(s), length((int)strlen(s)), first(0), current(0), internIds(true) { 
+    }
+
+Scanner::Scanner(const char* data, size_t size): input(data), length((int)size), first(0), current(0), internIds(true) { 
     }
 
 // -----------------------------
@@ -20,77 +32,221 @@ bool is_white_space(char c) {
     return c == ' ' || c == '\n' || c == '\r' || c == '\t';
 }
 
+// -----------------------------
+// Recorrido de rachas de caracteres
+// Cada función recibe la posición inicial y retorna la primera posición
+// que ya no pertenece a la clase. La ruta SSE2 procesa 16 bytes por
+// iteración mientras queden 16 bytes completos; el resto va por la
+// ruta escalar. Como la mayoría de las rachas son cortas (un espacio,
+// identificadores de pocas letras), los primeros 8 bytes se revisan
+// de forma escalar antes de pasar a SIMD.
+// -----------------------------
+
+static inline bool is_digit_char(char c) { return c >= '0' && c <= '9'; }
+
+static inline bool is_ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit_char(c) || c == '_';
+}
+
+#ifdef SCANNER_USE_SSE2
+// Bytes en [lo, hi]; los bytes >= 0x80 son negativos y quedan fuera
+static inline __m128i sse_in_range(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+// Posición del primer byte fuera de la clase, o 16 si todos pertenecen
+static inline int sse_first_miss(__m128i inClass) {
+    unsigned miss = ~(unsigned)_mm_movemask_epi8(inClass) & 0xFFFFu;
+    return miss ? __builtin_ctz(miss) : 16;
+}
+#endif
+
+static inline int skip_white_space(const char* s, int pos, int len) {
+#ifdef SCANNER_USE_SSE2
+    for (int k = 0; k < 8; ++k, ++pos) {
+        if (pos >= len || !is_white_space(s[pos])) return pos;
+    }
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+        int n = sse_first_miss(ws);
+        pos += n;
+        if (n < 16) return pos;
+    }
+#endif
+    while (pos < len && is_white_space(s[pos])) pos++;
+    return pos;
+}
+
+static inline int scan_digits(const char* s, int pos, int len) {
+#ifdef SCANNER_USE_SSE2
+    for (int k = 0; k < 8; ++k, ++pos) {
+        if (pos >= len || !is_digit_char(s[pos])) return pos;
+    }
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+        int n = sse_first_miss(sse_in_range(v, '0', '9'));
+        pos += n;
+        if (n < 16) return pos;
+    }
+#endif
+    while (pos < len && is_digit_char(s[pos])) pos++;
+    return pos;
+}
+
+static inline int scan_identifier(const char* s, int pos, int len) {
+#ifdef SCANNER_USE_SSE2
+    for (int k = 0; k < 8; ++k, ++pos) {
+        if (pos >= len || !is_ident_char(s[pos])) return pos;
+    }
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+        __m128i word = _mm_or_si128(
+            _mm_or_si128(sse_in_range(v, 'a', 'z'), sse_in_range(v, 'A', 'Z')),
+            _mm_or_si128(sse_in_range(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+        int n = sse_first_miss(word);
+        pos += n;
+        if (n < 16) return pos;
+    }
+#endif
+    while (pos < len && is_ident_char(s[pos])) pos++;
+    return pos;
+}
+
+// Clasifica una palabra [s, s+n) como palabra clave / tipo primitivo.
+// Switch por longitud y primer caracter sobre los bytes crudos: a lo sumo
+// un memcmp por identificador y ningún string temporal.
+// Retorna IDENTIFIER si no es palabra reservada.
+static Token::Type keyword_type(const char* s, int n) {
+    auto rest = [&](const char* kw) { return memcmp(s + 1, kw + 1, n - 1) == 0; };
+    switch (n) {
+        case 2:
+            switch (s[0]) {
+                case 'f': if (s[1] == 'n') return Token::FN;
+                          break;
+                case 'i': if (s[1] == 'n') return Token::IN;
+                          if (s[1] == 'f') return Token::IF;
+                          break;
+                case 'u': if (s[1] == '8') return Token::U8;
+                          break;
+            }
+            break;
+        case 3:
+            switch (s[0]) {
+                case 'l': if (rest("let")) return Token::LET;
+                          break;
+                case 'm': if (rest("mut")) return Token::MUT;
+                          break;
+                case 'f': if (rest("for")) return Token::FOR;
+                          if (rest("fun")) return Token::FUN;
+                          if (rest("f32")) return Token::F32;
+                          if (rest("f64")) return Token::F64;
+                          break;
+                case 'u': if (rest("u16")) return Token::U16;
+                          if (rest("u32")) return Token::U32;
+                          if (rest("u64")) return Token::U64;
+                          break;
+                case 'i': if (rest("i32")) return Token::I32;
+                          if (rest("i64")) return Token::I64;
+                          break;
+                case 'v': if (rest("var")) return Token::VAR;
+                          break;
+                case 'a': if (rest("and")) return Token::AND;
+                          break;
+            }
+            break;
+        case 4:
+            switch (s[0]) {
+                case 't': if (rest("type")) return Token::TYPE;
+                          if (rest("true")) return Token::TRUE;
+                          break;
+                case 'e': if (rest("else")) return Token::ELSE;
+                          break;
+                case 'b': if (rest("bool")) return Token::BOOL;
+                          break;
+            }
+            break;
+        case 5:
+            switch (s[0]) {
+                case 'w': if (rest("while")) return Token::WHILE;
+                          break;
+                case 'u': if (rest("usize")) return Token::USIZE;
+                          break;
+                case 'f': if (rest("false")) return Token::FALSE;
+                          break;
+                case 'p': if (rest("print")) return Token::PRINT;
+                          break;
+                case 'c': if (rest("const")) return Token::CONST;
+                          break;
+            }
+            break;
+        case 6:
+            switch (s[0]) {
+                case 's': if (rest("struct")) return Token::STRUCT;
+                          break;
+                case 'r': if (rest("return")) return Token::RETURN;
+                          break;
+                case 'e': if (rest("endfun")) return Token::ENDFUN;
+                          break;
+            }
+            break;
+        case 7:
+            if (s[0] == 'p' && rest("println")) return Token::PRINTLN;
+            break;
+    }
+    return Token::IDENTIFIER;
+}
+
 // -----------------------------
 // nextToken: obtiene el siguiente token
 // -----------------------------
 
 
-Token* Scanner::nextToken() {
+Token Scanner::nextToken() {
     auto peek = [&](int offset = 0) -> char {
         int idx = current + offset;
-        if (idx >= (int)input.size()) return '\0';
+        if (idx >= length) return '\0';
         return input[idx];
     };
 
+    // El token referencia [first, current) del buffer fuente
+    auto make = [&](Token::Type t) -> Token {
+        return Token(t, input, first, current - first);
+    };
+
     // Saltar espacios
-    while (current < (int)input.size() && is_white_space(input[current])) current++;
-    if (current >= (int)input.size()) return new Token(Token::END);
+    current = skip_white_space(input, current, length);
+    if (current >= length) return Token(Token::END, input, length, 0);
 
     first = current;
     char c = peek();
 
     // Números
     if (isdigit(c)) {
-        while (isdigit(peek())) current++;
+        current = scan_digits(input, current, length);
         // Check for float
         if (peek() == '.' && isdigit(peek(1))) {
             current++; // consume dot
-            while (isdigit(peek())) current++;
+            current = scan_digits(input, current, length);
         }
-        return new Token(Token::NUMBER, input, first, current - first);
+        return make(Token::NUMBER);
     }
 
     // Identificadores / palabras clave / macro println!
     if (isalpha(c) || c == '_') {
-        while (isalnum(peek()) || peek()=='_') current++;
-        string lexema = input.substr(first, current - first);
+        current = scan_identifier(input, current, length);
+        Token::Type kw = keyword_type(input + first, current - first);
         // Macro println!
-        if (lexema == "println") {
-            if (peek() == '!') { current++; return new Token(Token::PRINTLN, "println!", 0, 8); }
-            return new Token(Token::PRINTLN, lexema, 0, (int)lexema.size());
+        if (kw == Token::PRINTLN) {
+            if (peek() == '!') current++;
+            return make(Token::PRINTLN);
         }
-        // Palabras clave / tipos primitivos
-        if (lexema == "fn") return new Token(Token::FN, lexema, 0, (int)lexema.size());
-        if (lexema == "struct") return new Token(Token::STRUCT, lexema, 0, (int)lexema.size());
-        if (lexema == "type") return new Token(Token::TYPE, lexema, 0, (int)lexema.size());
-        if (lexema == "let") return new Token(Token::LET, lexema, 0, (int)lexema.size());
-        if (lexema == "mut") return new Token(Token::MUT, lexema, 0, (int)lexema.size());
-        if (lexema == "for") return new Token(Token::FOR, lexema, 0, (int)lexema.size());
-        if (lexema == "in") return new Token(Token::IN, lexema, 0, (int)lexema.size());
-        if (lexema == "if") return new Token(Token::IF, lexema, 0, (int)lexema.size());
-        if (lexema == "else") return new Token(Token::ELSE, lexema, 0, (int)lexema.size());
-        if (lexema == "while") return new Token(Token::WHILE, lexema, 0, (int)lexema.size());
-        if (lexema == "return") return new Token(Token::RETURN, lexema, 0, (int)lexema.size());
-        // Tipos primitivos
-        if (lexema == "u8") return new Token(Token::U8, lexema, 0, (int)lexema.size());
-        if (lexema == "u16") return new Token(Token::U16, lexema, 0, (int)lexema.size());
-        if (lexema == "u32") return new Token(Token::U32, lexema, 0, (int)lexema.size());
-        if (lexema == "u64") return new Token(Token::U64, lexema, 0, (int)lexema.size());
-        if (lexema == "usize") return new Token(Token::USIZE, lexema, 0, (int)lexema.size());
-        if (lexema == "i32") return new Token(Token::I32, lexema, 0, (int)lexema.size());
-        if (lexema == "i64") return new Token(Token::I64, lexema, 0, (int)lexema.size());
-        if (lexema == "f32") return new Token(Token::F32, lexema, 0, (int)lexema.size());
-        if (lexema == "f64") return new Token(Token::F64, lexema, 0, (int)lexema.size());
-        if (lexema == "bool") return new Token(Token::BOOL, lexema, 0, (int)lexema.size());
-        if (lexema == "true") return new Token(Token::TRUE, lexema, 0, (int)lexema.size());
-        if (lexema == "false") return new Token(Token::FALSE, lexema, 0, (int)lexema.size());
-        // Legacy soportado
-        if (lexema == "var") return new Token(Token::VAR, lexema, 0, (int)lexema.size());
-        if (lexema == "fun") return new Token(Token::FUN, lexema, 0, (int)lexema.size());
-        if (lexema == "endfun") return new Token(Token::ENDFUN, lexema, 0, (int)lexema.size());
-        if (lexema == "print") return new Token(Token::PRINT, lexema, 0, (int)lexema.size());
-        if (lexema == "and") return new Token(Token::AND, lexema, 0, (int)lexema.size());
-        return new Token(Token::IDENTIFIER, input, first, current - first);
+        Token tok = make(kw);
+        if (kw == Token::IDENTIFIER && internIds) tok.sym = global_interner().intern(tok.text);
+        return tok;
     }
 
     // String literal
@@ -102,58 +258,165 @@ Token* Scanner::nextToken() {
         }
         if (peek() == '"') {
             current++; // consume closing quote
-            return new Token(Token::STRING_LITERAL, input, first, current - first);
+            return make(Token::STRING_LITERAL);
         }
-        // error: string no cerrada
-        return new Token(Token::ERR, '"');
+        // error: string no cerrada (el token de error es la comilla inicial)
+        return Token(Token::ERR, input, first, 1);
     }
 
     // Multi-character operadores y símbolos
     // Orden importa (más largos primero)
     // ..
-    if (c == '.' && peek(1) == '.') {
-        current += 2;
-        return new Token(Token::DOTDOT, "..", 0, 2);
-    }
-    if (c == '-' && peek(1) == '>') { current += 2; return new Token(Token::ARROW, "->", 0, 2); }
-    if (c == '+' && peek(1) == '=') { current += 2; return new Token(Token::PLUS_ASSIGN, "+=", 0, 2); }
-    if (c == '-' && peek(1) == '=') { current += 2; return new Token(Token::MINUS_ASSIGN, "-=", 0, 2); }
-    if (c == '=' && peek(1) == '=') { current += 2; return new Token(Token::EQ, "==", 0, 2); }
-    if (c == '!' && peek(1) == '=') { current += 2; return new Token(Token::NEQ, "!=", 0, 2); }
-    if (c == '<' && peek(1) == '=') { current += 2; return new Token(Token::LE, "<=", 0, 2); }
-    if (c == '>' && peek(1) == '=') { current += 2; return new Token(Token::GE, ">=", 0, 2); }
-    if (c == '|' && peek(1) == '|') { current += 2; return new Token(Token::OR, "||", 0, 2); }
-    if (c == '&' && peek(1) == '&') { current += 2; return new Token(Token::AND, "&&", 0, 2); }
-    if (c == '*' && peek(1) == '*') { current += 2; return new Token(Token::POW, "**", 0, 2); }
+    if (c == '.' && peek(1) == '.') { current += 2; return make(Token::DOTDOT); }
+    if (c == '-' && peek(1) == '>') { current += 2; return make(Token::ARROW); }
+    if (c == '+' && peek(1) == '=') { current += 2; return make(Token::PLUS_ASSIGN); }
+    if (c == '-' && peek(1) == '=') { current += 2; return make(Token::MINUS_ASSIGN); }
+    if (c == '=' && peek(1) == '=') { current += 2; return make(Token::EQ); }
+    if (c == '!' && peek(1) == '=') { current += 2; return make(Token::NEQ); }
+    if (c == '<' && peek(1) == '=') { current += 2; return make(Token::LE); }
+    if (c == '>' && peek(1) == '=') { current += 2; return make(Token::GE); }
+    if (c == '|' && peek(1) == '|') { current += 2; return make(Token::OR); }
+    if (c == '&' && peek(1) == '&') { current += 2; return make(Token::AND); }
+    if (c == '*' && peek(1) == '*') { current += 2; return make(Token::POW); }
 
     // Un solo caracter
     current++;
     switch (c) {
-        case '+': return new Token(Token::PLUS, "+", 0, 1);
-        case '-': return new Token(Token::MINUS, "-", 0, 1);
-        case '*': return new Token(Token::MUL, "*", 0, 1);
-        case '/': return new Token(Token::DIV, "/", 0, 1);
-        case '%': return new Token(Token::MOD, "%", 0, 1);
-        case '(': return new Token(Token::LPAREN, "(", 0, 1);
-        case ')': return new Token(Token::RPAREN, ")", 0, 1);
-        case '{': return new Token(Token::LBRACE, "{", 0, 1);
-        case '}': return new Token(Token::RBRACE, "}", 0, 1);
-        case '[': return new Token(Token::LBRACKET, "[", 0, 1);
-        case ']': return new Token(Token::RBRACKET, "]", 0, 1);
-        case ',': return new Token(Token::COMMA, ",", 0, 1);
-        case ';': return new Token(Token::SEMICOL, ";", 0, 1);
-        case ':': return new Token(Token::COLON, ":", 0, 1);
-        case '.': return new Token(Token::DOT, ".", 0, 1);
-        case '=': return new Token(Token::ASSIGN, "=", 0, 1);
-        case '<': return new Token(Token::LT, "<", 0, 1);
-        case '>': return new Token(Token::GT, ">", 0, 1);
-        case '!': return new Token(Token::NOT, "!", 0, 1);
-        default: return new Token(Token::ERR, c);
+        case '+': return make(Token::PLUS);
+        case '-': return make(Token::MINUS);
+        case '*': return make(Token::MUL);
+        case '/': return make(Token::DIV);
+        case '%': return make(Token::MOD);
+        case '(': return make(Token::LPAREN);
+        case ')': return make(Token::RPAREN);
+        case '{': return make(Token::LBRACE);
+        case '}': return make(Token::RBRACE);
+        case '[': return make(Token::LBRACKET);
+        case ']': return make(Token::RBRACKET);
+        case ',': return make(Token::COMMA);
+        case ';': return make(Token::SEMICOL);
+        case ':': return make(Token::COLON);
+        case '.': return make(Token::DOT);
+        case '=': return make(Token::ASSIGN);
+        case '<': return make(Token::LT);
+        case '>': return make(Token::GT);
+        case '!': return make(Token::NOT);
+        default: return make(Token::ERR);
+    }
+}
+
+
+
+
+// -----------------------------
+// tokenize: lexea toda la entrada a un TokenBuffer
+// -----------------------------
+
+void Scanner::tokenize(TokenBuffer& out) {
+    out.clear();
+    out.source = input;
+    out.reserve(static_cast<size_t>(length - current) / 4 + 1);
+
+    while (true) {
+        Token tok = nextToken();
+        out.push(tok.type, tok.offset, static_cast<uint32_t>(tok.text.size()), tok.sym);
+        if (tok.type == Token::END) return;
+        if (tok.type == Token::ERR) return;
     }
 }
 
+bool Scanner::tokenizeUntil(TokenBuffer& out, size_t begin, size_t stop) {
+    out.clear();
+    out.source = input;
+    current = static_cast<int>(begin);
 
+    while (true) {
+        Token tok = nextToken();
+        if (tok.type == Token::ERR) {
+            out.push(tok.type, tok.offset, static_cast<uint32_t>(tok.text.size()), tok.sym);
+            return false;
+        }
+        if (tok.offset >= stop || tok.type == Token::END) {
+            if (tok.type == Token::END) out.push(tok.type, tok.offset, 0);
+            return tok.offset == stop;
+        }
+        out.push(tok.type, tok.offset, static_cast<uint32_t>(tok.text.size()), tok.sym);
+    }
+}
 
+// -----------------------------
+// tokenizeParallel: lexeo por trozos en varios hilos
+// -----------------------------
+
+// Por debajo de este tamaño crear hilos cuesta más que lexear
+static const int kParallelMinBytes = 1 << 20;
+
+void Scanner::tokenizeParallel(TokenBuffer& out, unsigned threads) {
+    int remaining = length - current;
+    if (threads <= 1 || remaining < kParallelMinBytes) {
+        tokenize(out);
+        return;
+    }
+
+    // Fronteras seguras: justo después de un '\n'. Ningún token cruza un
+    // salto de línea (los strings multilínea son error léxico), así que
+    // cada trozo se puede lexear de forma independiente.
+    vector<int> bounds;
+    bounds.push_back(current);
+    for (unsigned i = 1; i < threads; ++i) {
+        int cut = current + static_cast<int>(static_cast<long long>(remaining) * i / threads);
+        if (cut <= bounds.back()) continue;
+        const void* nl = memchr(input + cut, '\n', static_cast<size_t>(length - cut));
+        if (!nl) break;
+        cut = static_cast<int>(static_cast<const char*>(nl) - input) + 1;
+        if (cut > bounds.back() && cut < length) bounds.push_back(cut);
+    }
+    bounds.push_back(length);
+
+    size_t chunks = bounds.size() - 1;
+    vector<TokenBuffer> parts(chunks);
+    vector<int> stops(chunks);
+    vector<thread> workers;
+    workers.reserve(chunks);
+    for (size_t i = 0; i < chunks; ++i) {
+        workers.emplace_back([this, &bounds, &parts, &stops, i]() {
+            // Scanner del trozo: mismo buffer base, así los offsets son globales
+            Scanner chunk(input, static_cast<size_t>(bounds[i + 1]));
+            chunk.current = bounds[i];
+            chunk.internIds = false; // el interner no es thread-safe
+            chunk.tokenize(parts[i]);
+            stops[i] = chunk.current;
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    // Concatenar descartando los END intermedios; cortar en el primer ERR
+    size_t total = 0;
+    for (auto& part : parts) total += part.size();
+    out.clear();
+    out.source = input;
+    out.reserve(total);
+    for (size_t i = 0; i < chunks; ++i) {
+        TokenBuffer& part = parts[i];
+        size_t n = part.size();
+        bool hasError = part.kind(n - 1) == Token::ERR;
+        if (!hasError && i + 1 < chunks) --n; // END del trozo
+        out.kinds.insert(out.kinds.end(), part.kinds.begin(), part.kinds.begin() + n);
+        out.offsets.insert(out.offsets.end(), part.offsets.begin(), part.offsets.begin() + n);
+        out.lengths.insert(out.lengths.end(), part.lengths.begin(), part.lengths.begin() + n);
+        current = stops[i];
+        if (hasError) break;
+    }
+
+    // Internar identificadores en un solo hilo, en orden de aparición
+    out.symbols.assign(out.size(), kNoSymbol);
+    Interner& interner = global_interner();
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (out.kinds[i] == Token::IDENTIFIER) {
+            out.symbols[i] = interner.intern(string_view(input + out.offsets[i], out.lengths[i]));
+        }
+    }
+}
 
 // -----------------------------
 // Destructor
@@ -165,7 +428,7 @@ Scanner::~Scanner() { }
 // -----------------------------
 
 void ejecutar_scanner(Scanner* scanner, const string& InputFile) {
-    Token* tok;
+    Token tok;
 
     // Crear nombre para archivo de salida
     string OutputFileName = InputFile;
@@ -186,24 +449,21 @@ void ejecutar_scanner(Scanner* scanner, const string& InputFile) {
     while (true) {
         tok = scanner->nextToken();
 
-        if (tok->type == Token::END) {
-            outFile << *tok << endl;
-            delete tok;
+        if (tok.type == Token::END) {
+            outFile << tok << endl;
             outFile << "\nScanner exitoso" << endl << endl;
             outFile.close();
             return;
         }
 
-        if (tok->type == Token::ERR) {
-            outFile << *tok << endl;
-            delete tok;
+        if (tok.type == Token::ERR) {
+            outFile << tok << endl;
             outFile << "Caracter invalido" << endl << endl;
             outFile << "Scanner no exitoso" << endl << endl;
             outFile.close();
             return;
         }
 
-        outFile << *tok << endl;
-        delete tok;
+        outFile << tok << endl;
     }
 }
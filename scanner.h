@@ -7,16 +7,37 @@ using namespace std;
 
 class Scanner {
 private:
-    string input;
+    const char* input; // buffer fuente (no se copia; lo posee quien crea el Scanner)
+    int length;
     int first;
     int current;
+    bool internIds;    // internar identificadores en nextToken (desactivado en trozos paralelos)
 
 public:
-    // Constructor
+    // Constructores
     Scanner(const char* in_s);
+    Scanner(const char* data, size_t size);
 
-    // Retorna el siguiente token
-    Token* nextToken();
+    const char* source() const { return input; }
+    size_t size() const { return static_cast<size_t>(length); }
+
+    // Retorna el siguiente token (por valor; su texto apunta a input)
+    Token nextToken();
+
+    // Lexea todo el resto de la entrada en un buffer contiguo.
+    // Termina en END, o en el primer ERR si hay un error léxico.
+    void tokenize(TokenBuffer& out);
+
+    // Igual que tokenize, pero divide la entrada en trozos que terminan en
+    // salto de línea y los lexea en paralelo. El resultado es idéntico al
+    // de tokenize. Entradas pequeñas se lexean en serie.
+    void tokenizeParallel(TokenBuffer& out, unsigned threads);
+
+    // Lexea desde el byte begin hasta el primer token que empieza en stop
+    // o después (ése no se agrega; END sí). Retorna true si algún token
+    // empieza exactamente en stop, es decir, si el lexeo vuelve a coincidir
+    // con el del resto del archivo (reparseo incremental).
+    bool tokenizeUntil(TokenBuffer& out, size_t begin, size_t stop);
 
     // Destructor
     ~Scanner();
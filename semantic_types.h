@@ -1,6 +1,7 @@
 #ifndef SEMANTIC_TYPES_H
 #define SEMANTIC_TYPES_H
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 using namespace std;
@@ -12,7 +13,7 @@ using namespace std;
 class Type {
 public:
     // Ampliamos el conjunto para reflejar tokens Rust simplificados
-    enum TType { NOTYPE, VOID, BOOL, I32, I64, U32, U64, F32, F64 };
+    enum TType : uint8_t { NOTYPE, VOID, BOOL, I32, I64, U32, U64, F32, F64 };
     static const char* type_names[9];
 
     TType ttype;
@@ -46,6 +47,18 @@ public:
     }
 };
 
+// Índice de un tipo en la TypeTable (type_table.h)
+typedef uint32_t TypeId;
+const TypeId kNoType = 0; // tipo desconocido
+
+// Tipo de una declaración resuelto una sola vez por TypeCheckerVisitor:
+// descriptor en la TypeTable, tipo escalar y bytes que ocupa en el frame
+struct ResolvedType {
+    TypeId id = kNoType;
+    Type::TType scalar = Type::NOTYPE;
+    int size = 8;
+};
+
 inline const char* Type::type_names[9] = { "notype", "void", "bool", "i32", "i64", "u32", "u64", "f32", "f64" };
 
 #endif // SEMANTIC_TYPES_H
@@ -23,6 +23,30 @@ PORT = 5002
 # Ruta al compilador (en el mismo directorio que este script)
 COMPILER_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'compiler')
 
+# Cache de ASTs compartido entre requests: el mismo código no se vuelve a parsear
+AST_CACHE_DIR = os.path.join(tempfile.gettempdir(), 'rustc_ast_cache')
+
+# Versión del binario copiado, por fecha de modificación. El compilador base
+# no reconoce --version (sale con error): se toma como versión 1
+_compiler_version = {}
+
+
+def compiler_version():
+    """Versión que reporta `compiler --version`; 1 si no la reporta."""
+    mtime = os.path.getmtime(COMPILER_PATH)
+    if mtime not in _compiler_version:
+        version = 1
+        try:
+            result = subprocess.run([COMPILER_PATH, '--version'], capture_output=True, text=True, timeout=5)
+            words = result.stdout.split()
+            if result.returncode == 0 and words and words[-1].isdigit():
+                version = int(words[-1])
+        except (OSError, subprocess.TimeoutExpired):
+            pass
+        _compiler_version.clear()
+        _compiler_version[mtime] = version
+    return _compiler_version[mtime]
+
 
 def compile_rust_code(rust_code):
     """Compila código Rust y retorna el assembly generado."""
@@ -38,9 +62,12 @@ def compile_rust_code(rust_code):
         with open(rust_file, 'w') as f:
             f.write(rust_code)
         
-        # Ejecutar compilador
+        # Ejecutar compilador (--ast-cache existe desde la versión 2)
+        command = [COMPILER_PATH, rust_file]
+        if compiler_version() >= 2:
+            command += ['--ast-cache', AST_CACHE_DIR]
         result = subprocess.run(
-            [COMPILER_PATH, rust_file],
+            command,
             capture_output=True,
             text=True,
             timeout=10,
@@ -0,0 +1,161 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <utility>
+
+using namespace std;
+
+// ===========================================================
+//  Vector contiguo con capacidad inline para N elementos.
+//  Los primeros N viven dentro del propio objeto (sin heap);
+//  al superarlos se pasa a un bloque del heap que crece al
+//  doble. Lo usan los hijos de longitud variable del AST
+//  (sentencias de un bloque, argumentos de una llamada), que
+//  casi siempre son pocos y se recorren en orden.
+// ===========================================================
+
+template <typename T, size_t N>
+class SmallVector {
+private:
+    T* ptr;
+    uint32_t len;
+    uint32_t cap;
+    alignas(T) unsigned char inlineBuf[(N ? N : 1) * sizeof(T)];
+
+    T* inlineData() { return reinterpret_cast<T*>(inlineBuf); }
+    bool isInline() const { return ptr == reinterpret_cast<const T*>(inlineBuf); }
+
+    void destroyAll() {
+        for (uint32_t i = 0; i < len; i++) ptr[i].~T();
+        len = 0;
+    }
+
+    void releaseHeap() {
+        if (!isInline()) ::operator delete(ptr);
+        ptr = inlineData();
+        cap = N;
+    }
+
+    // Pasa a un bloque de newCap elementos moviendo los actuales
+    void regrow(size_t newCap) {
+        T* fresh = static_cast<T*>(::operator new(newCap * sizeof(T)));
+        for (uint32_t i = 0; i < len; i++) {
+            new (fresh + i) T(std::move(ptr[i]));
+            ptr[i].~T();
+        }
+        if (!isInline()) ::operator delete(ptr);
+        ptr = fresh;
+        cap = static_cast<uint32_t>(newCap);
+    }
+
+    // Toma los elementos de other (que queda vacía)
+    void stealFrom(SmallVector& other) {
+        if (other.isInline()) {
+            for (uint32_t i = 0; i < other.len; i++) {
+                new (ptr + i) T(std::move(other.ptr[i]));
+            }
+            len = other.len;
+            other.destroyAll();
+        } else {
+            ptr = other.ptr;
+            len = other.len;
+            cap = other.cap;
+            other.ptr = other.inlineData();
+            other.len = 0;
+            other.cap = N;
+        }
+    }
+
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() : ptr(inlineData()), len(0), cap(N) {}
+
+    SmallVector(const SmallVector& other) : SmallVector() { assign(other.begin(), other.end()); }
+
+    SmallVector(SmallVector&& other) noexcept : SmallVector() { stealFrom(other); }
+
+    ~SmallVector() {
+        destroyAll();
+        releaseHeap();
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            destroyAll();
+            releaseHeap();
+            stealFrom(other);
+        }
+        return *this;
+    }
+
+    template <typename It>
+    void assign(It first, It last) {
+        clear();
+        reserve(static_cast<size_t>(distance(first, last)));
+        for (; first != last; ++first) emplace_back(*first);
+    }
+
+    void reserve(size_t n) {
+        if (n > cap) regrow(n);
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (len == cap) {
+            // El nuevo elemento se construye antes de mover los viejos:
+            // args puede referirse a un elemento de este mismo vector
+            size_t newCap = cap ? 2 * static_cast<size_t>(cap) : 4;
+            T* fresh = static_cast<T*>(::operator new(newCap * sizeof(T)));
+            new (fresh + len) T(std::forward<Args>(args)...);
+            for (uint32_t i = 0; i < len; i++) {
+                new (fresh + i) T(std::move(ptr[i]));
+                ptr[i].~T();
+            }
+            if (!isInline()) ::operator delete(ptr);
+            ptr = fresh;
+            cap = static_cast<uint32_t>(newCap);
+        } else {
+            new (ptr + len) T(std::forward<Args>(args)...);
+        }
+        return ptr[len++];
+    }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    void pop_back() { ptr[--len].~T(); }
+    void clear() { destroyAll(); }
+
+    size_t size() const { return len; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return len == 0; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    T& front() { return ptr[0]; }
+    const T& front() const { return ptr[0]; }
+    T& back() { return ptr[len - 1]; }
+    const T& back() const { return ptr[len - 1]; }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + len; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + len; }
+};
+
+#endif // SMALL_VECTOR_H
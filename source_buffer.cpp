@@ -0,0 +1,91 @@
+#include "source_buffer.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+using namespace std;
+
+// -----------------------------
+// Constructor / Destructor
+// -----------------------------
+
+SourceBuffer::SourceBuffer() : ptr(""), length(0), mapped(false) { }
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+void SourceBuffer::release() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char*>(ptr), length);
+#endif
+    ptr = "";
+    length = 0;
+    mapped = false;
+    owned.clear();
+}
+
+// -----------------------------
+// Carga del archivo
+// -----------------------------
+
+bool SourceBuffer::open(const string& path) {
+    release();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+
+    // Archivo vacío: mmap no acepta longitud 0
+    if (fileSize == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+        ::close(fd);
+        madvise(addr, fileSize, MADV_SEQUENTIAL);
+        ptr = static_cast<const char*>(addr);
+        length = fileSize;
+        mapped = true;
+        return true;
+    }
+
+    // Sin mmap (p.ej. pipes o sistemas de archivos especiales): una sola lectura
+    owned.resize(fileSize);
+    size_t done = 0;
+    while (done < fileSize) {
+        ssize_t n = ::read(fd, &owned[done], fileSize - done);
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    owned.resize(done);
+#else
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in.is_open()) return false;
+    streamsize fileSize = in.tellg();
+    in.seekg(0);
+    owned.resize(static_cast<size_t>(fileSize));
+    in.read(&owned[0], fileSize);
+    owned.resize(static_cast<size_t>(in.gcount()));
+#endif
+
+    ptr = owned.data();
+    length = owned.size();
+    return true;
+}
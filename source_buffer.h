@@ -0,0 +1,41 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// ===========================================================
+//  Buffer de solo lectura con el contenido del archivo fuente.
+//  En POSIX se mapea el archivo con mmap; si no es posible se
+//  lee completo con una única lectura del tamaño del archivo.
+//  El Scanner lexea directamente sobre este buffer, por lo que
+//  debe vivir mientras existan tokens que apunten a él.
+// ===========================================================
+
+class SourceBuffer {
+private:
+    const char* ptr;
+    size_t length;
+    bool mapped;     // true si ptr proviene de mmap
+    string owned;    // respaldo cuando no se pudo mapear
+
+    void release();
+
+public:
+    SourceBuffer();
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    // Carga el archivo; retorna false si no se pudo abrir o leer
+    bool open(const string& path);
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool isMapped() const { return mapped; }
+};
+
+#endif // SOURCE_BUFFER_H
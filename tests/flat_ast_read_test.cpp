@@ -0,0 +1,79 @@
+// FlatAst::read sobre archivos corruptos. Serializa el AST de cada fuente
+// pasado como argumento y lo lee de nuevo con bytes pisados (uno a uno y
+// en tramos de 64), largos inflados y cortes en cada posición. Cada intento
+// debe leerse y materializarse o fallar con runtime_error; run_tests.py
+// compila este archivo con -fsanitize=address,undefined para que una
+// lectura fuera de los vectores también cuente como falla.
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "../scanner.h"
+#include "../parser.h"
+#include "../flat_ast.h"
+
+using namespace std;
+
+static size_t accepted = 0, rejected = 0;
+
+static void tryRead(const string& blob) {
+    istringstream in(blob);
+    try {
+        FlatAst ast = FlatAst::read(in);
+        delete ast.materialize();
+        accepted++;
+    } catch (const runtime_error&) {
+        rejected++;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        ifstream file(argv[i], ios::binary);
+        stringstream ss;
+        ss << file.rdbuf();
+        string source = ss.str();
+
+        Program* program = nullptr;
+        try {
+            Scanner scanner(source.data(), source.size());
+            TokenBuffer tokens;
+            scanner.tokenize(tokens);
+            Parser parser(&tokens);
+            program = parser.parseProgram();
+        } catch (const runtime_error&) {
+            continue; // fuentes con errores a propósito
+        }
+        ostringstream os;
+        FlatAst::fromProgram(program).write(os);
+        delete program;
+        const string blob = os.str();
+
+        // El archivo intacto se lee siempre
+        size_t before = rejected;
+        tryRead(blob);
+        if (rejected != before) {
+            cerr << argv[i] << ": no se pudo leer el AST sin corromper" << endl;
+            return 1;
+        }
+
+        // Pasos de a 1 en archivos chicos; en los grandes, de a varios
+        size_t step = blob.size() / 2048 + 1;
+        for (size_t pos = 0; pos < blob.size(); pos += step) {
+            for (unsigned char v : {0x00, 0x01, 0x7f, 0x80, 0xff}) {
+                string bad = blob;
+                bad[pos] = static_cast<char>(v);
+                tryRead(bad);
+            }
+            for (char fill : {'\x00', '\xff'}) {
+                string bad = blob;
+                bad.replace(pos, 64, min<size_t>(64, blob.size() - pos), fill);
+                tryRead(bad);
+            }
+            tryRead(blob.substr(0, pos));
+        }
+    }
+    cout << accepted << " leídos, " << rejected << " rechazados" << endl;
+    return 0;
+}
@@ -0,0 +1,131 @@
+// reparseEdit contra un compilado completo. Para cada fuente pasado como
+// argumento se aplican, de a una, ediciones dentro de un único item: cambiar
+// cada literal entero y agregar un let al comienzo de cada función. El
+// Program reparseado debe dar el mismo AST plano (con offsets) y el mismo
+// assembly que lexear y parsear todo el fuente editado. Imprime una línea
+// por edición que no coincide y un resumen al final.
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../scanner.h"
+#include "../parser.h"
+#include "../visitor.h"
+#include "../flat_ast.h"
+#include "../line_table.h"
+#include "../incremental.h"
+
+using namespace std;
+
+struct Edit {
+    uint32_t start;
+    uint32_t oldEnd;
+    string text;
+};
+
+struct Compiled {
+    bool ok = false;
+    string ast;
+    string assembly;
+};
+
+// Assembly con --source-lines: los offsets del AST también se comparan
+static Compiled compile(Program* program, const string& source) {
+    Compiled c;
+    ostringstream ast, assembly;
+    FlatAst::fromProgram(program).write(ast);
+    LineTable lines(source.data(), source.size());
+    GenCodeVisitor codigo(assembly);
+    codigo.enableOptimizations(true);
+    codigo.enableDAGOptimization(true);
+    codigo.enablePeepholeOptimization(true);
+    codigo.setSourceLines(&lines);
+    codigo.generar(program);
+    c.ok = true;
+    c.ast = ast.str();
+    c.assembly = assembly.str();
+    return c;
+}
+
+static Program* parseAll(const string& source, TokenBuffer& tokens) {
+    Scanner(source.data(), source.size()).tokenize(tokens);
+    return Parser(&tokens).parseProgram();
+}
+
+int main(int argc, char* argv[]) {
+    ostringstream sink; // "Parseo exitoso" y otros mensajes del compilador
+    streambuf* saved = cout.rdbuf(sink.rdbuf());
+    size_t edits = 0, incremental = 0, failures = 0;
+
+    for (int f = 1; f < argc; f++) {
+        ifstream in(argv[f], ios::binary);
+        stringstream ss;
+        ss << in.rdbuf();
+        const string source = ss.str();
+
+        TokenBuffer tokens;
+        Program* original = nullptr;
+        try {
+            original = parseAll(source, tokens);
+        } catch (const runtime_error&) {
+            continue; // fuentes con errores a propósito
+        }
+        delete original;
+
+        vector<Edit> plan;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            if (tokens.kinds[i] == Token::NUMBER) {
+                plan.push_back({tokens.offsets[i], tokens.offsets[i] + tokens.lengths[i],
+                                "1" + source.substr(tokens.offsets[i], tokens.lengths[i])});
+            } else if (tokens.kinds[i] == Token::FN) {
+                size_t k = i;
+                while (k < tokens.size() && tokens.kinds[k] != Token::LBRACE) k++;
+                if (k == tokens.size()) continue;
+                uint32_t at = tokens.offsets[k] + 1;
+                plan.push_back({at, at, " let incr_extra: i64 = 3;"});
+            }
+        }
+
+        for (const Edit& e : plan) {
+            string edited = source;
+            edited.replace(e.start, e.oldEnd - e.start, e.text);
+            SourceEdit edit = {e.start, e.oldEnd, static_cast<uint32_t>(e.start + e.text.size())};
+            string where = string(argv[f]) + " @" + to_string(e.start) + " '" + e.text + "'";
+            edits++;
+
+            Compiled full, live;
+            TokenBuffer fullTokens, liveTokens;
+            Program* fullProgram = nullptr;
+            Program* liveProgram = nullptr;
+            try {
+                fullProgram = parseAll(edited, fullTokens);
+                full = compile(fullProgram, edited);
+            } catch (const runtime_error&) {
+            }
+            try {
+                liveProgram = parseAll(source, liveTokens);
+                ReparseResult r = reparseEdit(edited.data(), edited.size(), edit, liveTokens, liveProgram);
+                if (r.incremental) incremental++;
+                live = compile(liveProgram, edited);
+            } catch (const runtime_error&) {
+            }
+            delete fullProgram;
+            delete liveProgram;
+
+            const char* problem = nullptr;
+            if (full.ok != live.ok) problem = full.ok ? "el reparseo falla" : "el compilado completo falla";
+            else if (full.assembly != live.assembly) problem = "assembly distinto";
+            else if (full.ast != live.ast) problem = "AST distinto";
+            if (problem) {
+                failures++;
+                cerr << where << ": " << problem << endl;
+            }
+        }
+    }
+
+    cout.rdbuf(saved);
+    cout << edits << " ediciones, " << incremental << " incrementales, " << failures << " distintas" << endl;
+    return failures == 0 && incremental > 0 ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Pruebas del compilador. Uso: python3 tests/run_tests.py (desde cualquier carpeta)
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+tests_dir = os.path.join(root, "tests")
+build_dir = tempfile.mkdtemp(prefix="rust_tests_")
+
+# Corpus de fuentes de ejemplo
+corpus = sorted(glob.glob(os.path.join(root, "inputs", "*.txt")))
+corpus += sorted(glob.glob(os.path.join(root, "tests_optimizaciones", "*.txt")))
+
+failures = []
+
+
+def compile_cpp(output, sources, flags=()):
+    cmd = ["g++", "-std=c++17", "-O1", "-pthread"] + list(flags) + sources + ["-o", output]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        print("Error en compilación:", " ".join(cmd))
+        print(result.stderr)
+        sys.exit(1)
+    return output
+
+
+def check(name, ok, detail=""):
+    print(("OK    " if ok else "FALLA ") + name)
+    if not ok:
+        failures.append(name)
+        if detail:
+            print(detail)
+
+
+# -----------------------------------------------------------------------------
+# Scanner: la ruta SSE2 y la escalar (-DSCANNER_NO_SIMD) dan los mismos tokens
+# -----------------------------------------------------------------------------
+
+scanner_sources = [os.path.join(tests_dir, "scanner_simd_test.cpp")]
+scanner_sources += [os.path.join(root, f) for f in ["scanner.cpp", "token.cpp", "interner.cpp"]]
+simd = compile_cpp(os.path.join(build_dir, "scanner_simd"), scanner_sources)
+scalar = compile_cpp(os.path.join(build_dir, "scanner_scalar"), scanner_sources, ["-DSCANNER_NO_SIMD"])
+
+dumps = []
+for binary in [simd, scalar]:
+    result = subprocess.run([binary] + corpus, capture_output=True)
+    if result.returncode != 0:
+        print(result.stderr.decode(errors="replace"))
+        sys.exit(1)
+    dumps.append(result.stdout.decode(errors="replace").splitlines())
+
+detail = ""
+if dumps[0] != dumps[1]:
+    for k, (a, b) in enumerate(zip(dumps[0], dumps[1])):
+        if a != b:
+            detail = f"  línea {k + 1}: SSE2 '{a}' / escalar '{b}'"
+            break
+    else:
+        detail = f"  largos distintos: {len(dumps[0])} / {len(dumps[1])} líneas"
+cases = sum(1 for line in dumps[0] if line.startswith("#"))
+check(f"scanner SSE2 = escalar ({cases} casos)", dumps[0] == dumps[1], detail)
+
+# -----------------------------------------------------------------------------
+# FlatAst::read: un archivo corrupto se rechaza con runtime_error, sin leer
+# fuera de los vectores (con sanitizers)
+# -----------------------------------------------------------------------------
+
+library = [os.path.join(root, f) for f in sorted(os.listdir(root)) if f.endswith(".cpp") and f != "main.cpp"]
+flat_read = compile_cpp(os.path.join(build_dir, "flat_ast_read"),
+                        [os.path.join(tests_dir, "flat_ast_read_test.cpp")] + library,
+                        ["-g", "-fsanitize=address,undefined", "-fno-sanitize-recover=all"])
+result = subprocess.run([flat_read] + corpus, capture_output=True, text=True)
+summary = result.stdout.strip().splitlines()[-1:] or [""]
+check(f"FlatAst::read con archivos corruptos ({summary[0]})", result.returncode == 0,
+      result.stderr[-2000:])
+
+# -----------------------------------------------------------------------------
+# reparseEdit: editar un item y reparsear da el mismo AST y assembly que un
+# compilado completo del fuente editado
+# -----------------------------------------------------------------------------
+
+incremental = compile_cpp(os.path.join(build_dir, "incremental"),
+                          [os.path.join(tests_dir, "incremental_test.cpp")] + library)
+result = subprocess.run([incremental] + corpus, capture_output=True, text=True)
+summary = result.stdout.strip().splitlines()[-1:] or [""]
+check(f"reparseo incremental = compilado completo ({summary[0]})", result.returncode == 0,
+      result.stderr[-2000:])
+
+# -----------------------------------------------------------------------------
+# Extremo a extremo: tests/cases/X.txt se compila (con y sin --hash-cons), se
+# ensambla con gcc y su salida debe ser tests/cases/X.out
+# -----------------------------------------------------------------------------
+
+compiler = compile_cpp(os.path.join(build_dir, "compiler"), [os.path.join(root, "main.cpp")] + library)
+
+
+def run_case(source, flags):
+    name = os.path.splitext(os.path.basename(source))[0]
+    work = os.path.join(build_dir, name + "".join(flags).replace("-", "_"))
+    os.makedirs(work, exist_ok=True)
+    program = os.path.join(work, name + ".txt")
+    shutil.copy(source, program)
+    result = subprocess.run([compiler, program] + flags, capture_output=True, text=True)
+    if result.returncode != 0:
+        return None, result.stdout + result.stderr
+    binary = os.path.join(work, name)
+    result = subprocess.run(["gcc", "-no-pie", os.path.join(work, name + ".s"), "-o", binary],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        return None, result.stderr
+    result = subprocess.run([binary], capture_output=True, text=True, timeout=10)
+    return [line.rstrip() for line in result.stdout.splitlines()], ""
+
+
+for source in sorted(glob.glob(os.path.join(tests_dir, "cases", "*.txt"))):
+    with open(os.path.splitext(source)[0] + ".out") as f:
+        expected = [line.rstrip() for line in f.read().splitlines()]
+    for flags in [[], ["--hash-cons"]]:
+        output, error = run_case(source, flags)
+        detail = error or f"  esperado {expected}\n  obtenido {output}"
+        check(" ".join([os.path.basename(source)] + flags), output == expected, detail)
+
+# -----------------------------------------------------------------------------
+# --ast-cache: una entrada corrupta cuenta como fallo y se recompila
+# -----------------------------------------------------------------------------
+
+cache_dir = os.path.join(build_dir, "ast_cache")
+work = os.path.join(build_dir, "cache")
+os.makedirs(work, exist_ok=True)
+for source in corpus:
+    name = os.path.basename(source)
+    program = os.path.join(work, name)
+    shutil.copy(source, program)
+    assembly = os.path.splitext(program)[0] + ".s"
+    outputs, hits = [], []
+    for run in range(3):
+        if run == 1:
+            # Pisar 64 bytes en medio de la entrada recién guardada
+            for entry in glob.glob(os.path.join(cache_dir, "*.fast")):
+                with open(entry, "r+b") as f:
+                    size = f.seek(0, 2)
+                    f.seek(size // 2)
+                    f.write(b"\xff" * 64)
+        result = subprocess.run([compiler, program, "--ast-cache", cache_dir], capture_output=True, text=True)
+        outputs.append((result.returncode, open(assembly).read() if os.path.exists(assembly) else None))
+        hits.append("AST leído del cache" in result.stdout)
+    shutil.rmtree(cache_dir, ignore_errors=True)
+    if outputs[0][0] != 0:
+        continue  # fuentes con errores a propósito
+    check(f"--ast-cache con entrada corrupta: {name}",
+          outputs[0] == outputs[1] == outputs[2] and hits == [False, False, True],
+          f"  códigos de salida {[o[0] for o in outputs]}, leídos del cache {hits}")
+
+print()
+if failures:
+    print(f"{len(failures)} prueba(s) fallaron")
+    sys.exit(1)
+print("Todas las pruebas pasaron")
@@ -0,0 +1,75 @@
+// Volcado canónico de tokens para comparar la ruta SSE2 del scanner con la
+// escalar. run_tests.py compila este archivo dos veces (con y sin
+// -DSCANNER_NO_SIMD) y exige que ambos binarios impriman exactamente lo
+// mismo.
+//
+// Se lexean los archivos pasados como argumento y, además, casos generados:
+// rachas de espacios, identificadores y dígitos de largo 0..48 desplazadas
+// 0..17 bytes (cruzan los bordes de 16 bytes de las cargas SSE2) y cortadas
+// por distintos terminadores o por el fin del buffer. Cada caso vive en un
+// buffer del tamaño exacto, sin '\0' ni relleno detrás.
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../scanner.h"
+
+using namespace std;
+
+static void dump(const string& name, const string& text) {
+    vector<char> exact(text.begin(), text.end()); // sin terminador
+    Scanner scanner(exact.data(), exact.size());
+    TokenBuffer tokens;
+    scanner.tokenize(tokens);
+    cout << "# " << name << " (" << text.size() << " bytes)\n";
+    for (size_t i = 0; i < tokens.size(); i++) {
+        cout << static_cast<int>(tokens.kinds[i]) << ' ' << tokens.offsets[i] << ' ' << tokens.lengths[i] << '\n';
+    }
+}
+
+static string run(const string& alphabet, int length) {
+    string s;
+    for (int i = 0; i < length; i++) s += alphabet[(i * 7 + i / 3) % alphabet.size()];
+    return s;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        ifstream in(argv[i], ios::binary);
+        if (!in) {
+            cerr << "No se pudo abrir: " << argv[i] << endl;
+            return 1;
+        }
+        stringstream ss;
+        ss << in.rdbuf();
+        dump(argv[i], ss.str());
+    }
+
+    // Clase de la racha, con un primer carácter que la inicia como token
+    struct Run {
+        const char* name;
+        const char* lead;
+        const char* alphabet;
+    };
+    const Run runs[] = {
+        {"espacios", "", " \t\r\n"},
+        {"identificador", "v", "abcxyzABCXYZ0123456789_"},
+        {"digitos", "", "0123456789"},
+    };
+    // "" = la racha llega al fin del buffer
+    const string terminators[] = {"", ";", " ", ".5", "a", "\xC3\xB1", "{"};
+
+    for (const Run& r : runs) {
+        for (int length = 0; length <= 48; length++) {
+            for (int shift = 0; shift <= 17; shift++) {
+                for (size_t t = 0; t < sizeof(terminators) / sizeof(terminators[0]); t++) {
+                    string text = string(shift, ' ') + "x=" + r.lead + run(r.alphabet, length) + terminators[t];
+                    dump(string(r.name) + " largo=" + to_string(length) + " desplazamiento=" + to_string(shift) +
+                         " terminador=" + to_string(t), text);
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -7,14 +7,14 @@ using namespace std;
 // Constructores
 // -----------------------------
 
-Token::Token(Type type) 
-    : type(type), text("") { }
+Token::Token()
+    : type(END), text(), sym(kNoSymbol), offset(0) { }
 
-Token::Token(Type type, char c) 
-    : type(type), text(string(1, c)) { }
+Token::Token(Type type) 
+    : type(type), text(), sym(kNoSymbol), offset(0) { }
 
-Token::Token(Type type, const string& source, int first, int last) 
-    : type(type), text(source.substr(first, last)) { }
+Token::Token(Type type, const char* source, int first, int length) 
+    : type(type), text(source + first, length), sym(kNoSymbol), offset(static_cast<uint32_t>(first)) { }
 
 // -----------------------------
 // Sobrecarga de operador <<
@@ -79,6 +79,7 @@ ostream& operator<<(ostream& outs, const Token& tok) {
         case Token::WHILE: outs << "TOKEN(WHILE, \"" << tok.text << "\")"; break;
         case Token::RETURN: outs << "TOKEN(RETURN, \"" << tok.text << "\")"; break;
         case Token::PRINTLN: outs << "TOKEN(PRINTLN, \"" << tok.text << "\")"; break;
+        case Token::CONST: outs << "TOKEN(CONST, \"" << tok.text << "\")"; break;
 
         // Tipos primitivos
         case Token::U8: outs << "TOKEN(U8)"; break;
@@ -1,8 +1,12 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <ostream>
+#include <vector>
+#include "interner.h"
 
 using namespace std;
 
@@ -42,7 +46,7 @@ public:
         EQ, NEQ, LT, GT, LE, GE, // == != < > <= >=
 
         // Palabras clave
-        FN, STRUCT, TYPE, LET, MUT, FOR, IN, IF, ELSE, WHILE, RETURN, PRINTLN,
+        FN, STRUCT, TYPE, LET, MUT, FOR, IN, IF, ELSE, WHILE, RETURN, PRINTLN, CONST,
 
         // Tipos primitivos
         U8, U16, U32, U64, USIZE, I32, I64, F32, F64, BOOL,
@@ -54,16 +58,66 @@ public:
 
     // Atributos
     Type type;
-    string text;
+    string_view text; // vista sobre el buffer fuente (sin copia); válida mientras viva el Scanner
+    SymbolId sym;     // id internado (sólo IDENTIFIER; kNoSymbol en otro caso)
+    uint32_t offset;  // offset en bytes dentro del buffer fuente (ver LineTable)
 
     // Constructores
+    Token();
     Token(Type type);
-    Token(Type type, char c);
-    Token(Type type, const string& source, int first, int last);
+    Token(Type type, const char* source, int first, int length);
 
     // Sobrecarga de operadores de salida
     friend ostream& operator<<(ostream& outs, const Token& tok);
     friend ostream& operator<<(ostream& outs, const Token* tok);
 };
 
+// ===========================================================
+//  Buffer contiguo de tokens (estructura de arreglos).
+//  Guarda por token sólo su tipo, offset y longitud dentro del
+//  buffer fuente; el Parser lo recorre por índice y etapas
+//  posteriores pueden trabajar sobre él sin volver a lexear.
+// ===========================================================
+
+struct TokenBuffer {
+    const char* source = nullptr;
+    vector<uint8_t> kinds;
+    vector<uint32_t> offsets;
+    vector<uint32_t> lengths;
+    vector<SymbolId> symbols;
+
+    size_t size() const { return kinds.size(); }
+    bool empty() const { return kinds.empty(); }
+
+    Token::Type kind(size_t i) const { return static_cast<Token::Type>(kinds[i]); }
+
+    // Reconstruye el token i (vista sobre source, sin copia)
+    Token token(size_t i) const {
+        Token tok(kind(i), source, static_cast<int>(offsets[i]), static_cast<int>(lengths[i]));
+        tok.sym = symbols[i];
+        return tok;
+    }
+
+    void push(Token::Type t, uint32_t offset, uint32_t length, SymbolId sym = kNoSymbol) {
+        kinds.push_back(static_cast<uint8_t>(t));
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        symbols.push_back(sym);
+    }
+
+    void reserve(size_t n) {
+        kinds.reserve(n);
+        offsets.reserve(n);
+        lengths.reserve(n);
+        symbols.reserve(n);
+    }
+
+    void clear() {
+        kinds.clear();
+        offsets.clear();
+        lengths.clear();
+        symbols.clear();
+    }
+};
+
 #endif // TOKEN_H
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "type_table.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+using namespace std;
+
+// Una cadena de alias más larga que esto sólo puede ser un ciclo
+static const int kMaxAliasDepth = 64;
+
+// Estados de layoutStructs
+enum : uint8_t { kPending, kInProgress, kDone };
+
+static uint32_t align_up(uint32_t value, uint32_t align) {
+    return (value + align - 1) / align * align;
+}
+
+// -----------------------------
+// Construcción
+// -----------------------------
+
+TypeTable::TypeTable() {
+    clear();
+}
+
+void TypeTable::clear() {
+    types.clear();
+    ids.clear();
+    aliases.clear();
+    constants.clear();
+    pendingFields.clear();
+    pendingOrder.clear();
+    structOrder.clear();
+
+    TypeDesc unknown;
+    unknown.name = "notype";
+    add(unknown); // kNoType
+
+    addScalar("void", Type::VOID, 0);
+    addScalar("bool", Type::BOOL, 4);
+    addScalar("i32", Type::I32, 4);
+    addScalar("i64", Type::I64, 8);
+    addScalar("u32", Type::U32, 4);
+    addScalar("u64", Type::U64, 8);
+    addScalar("f32", Type::F32, 4);
+    addScalar("f64", Type::F64, 8);
+    ids["int"] = ids["i32"]; // "int" legacy
+}
+
+TypeId TypeTable::add(TypeDesc desc) {
+    TypeId id = static_cast<TypeId>(types.size());
+    ids[desc.name] = id;
+    types.push_back(std::move(desc));
+    return id;
+}
+
+TypeId TypeTable::addScalar(const char* name, Type::TType tt, uint32_t size) {
+    TypeDesc desc;
+    desc.kind = TypeDesc::SCALAR;
+    desc.scalar = tt;
+    desc.size = size;
+    desc.align = size ? size : 1;
+    desc.name = name;
+    return add(std::move(desc));
+}
+
+TypeId TypeTable::arrayOf(TypeId element, uint32_t length) {
+    string name = types[element].name + "[" + to_string(length) + "]";
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    TypeDesc desc;
+    desc.kind = TypeDesc::ARRAY;
+    desc.element = element;
+    desc.length = length;
+    desc.size = types[element].size * length;
+    desc.align = types[element].align;
+    desc.name = std::move(name);
+    return add(std::move(desc));
+}
+
+// -----------------------------
+// Alias y structs
+// -----------------------------
+
+void TypeTable::addAlias(const string& alias, const string& target) {
+    aliases[alias] = target;
+}
+
+TypeId TypeTable::declareStruct(const string& name, const vector<pair<string, string>>& fields) {
+    auto it = ids.find(name);
+    if (it != ids.end() && types[it->second].kind == TypeDesc::STRUCT) {
+        // Redeclaración: vale la última, como antes
+        pendingFields[it->second] = fields;
+        return it->second;
+    }
+    TypeDesc desc;
+    desc.kind = TypeDesc::STRUCT;
+    desc.size = 0;
+    desc.align = 1;
+    desc.name = name;
+    TypeId id = add(std::move(desc));
+    pendingFields[id] = fields;
+    pendingOrder.push_back(id);
+    structOrder.push_back(id);
+    return id;
+}
+
+void TypeTable::layoutStructs() {
+    vector<uint8_t> state(types.size(), kPending);
+    for (TypeId id : pendingOrder) layout(id, state);
+    pendingFields.clear();
+    pendingOrder.clear();
+}
+
+void TypeTable::layout(TypeId id, vector<uint8_t>& state) {
+    if (id >= state.size()) state.resize(types.size(), kPending);
+    if (state[id] == kDone) return;
+    if (state[id] == kInProgress) {
+        throw runtime_error("Error semántico: el struct " + types[id].name + " se contiene a sí mismo");
+    }
+    state[id] = kInProgress;
+
+    if (types[id].kind == TypeDesc::ARRAY) {
+        TypeId element = types[id].element;
+        layout(element, state);
+        types[id].size = types[element].size * types[id].length;
+        types[id].align = types[element].align;
+    } else if (types[id].kind == TypeDesc::STRUCT) {
+        vector<FieldDesc> fields;
+        auto pending = pendingFields.find(id);
+        if (pending != pendingFields.end()) {
+            for (auto& f : pending->second) {
+                TypeId type = intern(f.second);
+                layout(type, state);
+                fields.push_back(FieldDesc{f.first, type, 0});
+            }
+        }
+
+        // Orden de ubicación: el declarado, o por alineación decreciente
+        vector<size_t> order(fields.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        if (reorderFields) {
+            stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return types[fields[a].type].align > types[fields[b].type].align;
+            });
+        }
+
+        uint32_t offset = 0, align = 1, used = 0;
+        for (size_t i : order) {
+            const TypeDesc& ft = types[fields[i].type];
+            offset = align_up(offset, ft.align);
+            fields[i].offset = offset;
+            offset += ft.size;
+            used += ft.size;
+            align = max(align, ft.align);
+        }
+        types[id].fields = std::move(fields);
+        types[id].size = align_up(offset, align);
+        types[id].align = align;
+        types[id].padding = types[id].size - used;
+    }
+
+    if (id >= state.size()) state.resize(types.size(), kPending);
+    state[id] = kDone;
+}
+
+// -----------------------------
+// Resolución de nombres escritos
+// -----------------------------
+
+TypeId TypeTable::intern(const string& spelled) {
+    return resolve(spelled, 0);
+}
+
+TypeId TypeTable::resolve(const string& spelled, int depth) {
+    auto memo = ids.find(spelled);
+    if (memo != ids.end()) return memo->second;
+    if (depth > kMaxAliasDepth) {
+        throw runtime_error("Error semántico: alias de tipo circular en " + spelled);
+    }
+
+    // Base ("i32", alias o struct) seguida de cero o más sufijos [N]
+    size_t bracket = spelled.find('[');
+    string base = spelled.substr(0, bracket);
+    TypeId id = kNoType;
+    auto known = ids.find(base);
+    if (known != ids.end()) {
+        id = known->second;
+    } else {
+        auto alias = aliases.find(base);
+        if (alias != aliases.end()) id = resolve(alias->second, depth + 1);
+    }
+    while (bracket != string::npos) {
+        size_t close = spelled.find(']', bracket);
+        if (close == string::npos) break;
+        id = arrayOf(id, arrayLength(spelled.substr(bracket + 1, close - bracket - 1)));
+        bracket = spelled.find('[', close);
+    }
+
+    ids[spelled] = id;
+    return id;
+}
+
+// Largo escrito entre corchetes: un literal o una constante
+uint32_t TypeTable::arrayLength(const string& spelled) const {
+    if (!spelled.empty() && isdigit(static_cast<unsigned char>(spelled[0]))) {
+        return static_cast<uint32_t>(stoul(spelled));
+    }
+    auto it = constants.find(spelled);
+    if (it == constants.end()) {
+        throw runtime_error("Error semántico: el largo de arreglo " + spelled + " no es una constante");
+    }
+    if (it->second < 0 || it->second > static_cast<int64_t>(UINT32_MAX)) {
+        throw runtime_error("Error semántico: largo de arreglo fuera de rango: " + spelled);
+    }
+    return static_cast<uint32_t>(it->second);
+}
+
+// -----------------------------
+// Consultas
+// -----------------------------
+
+const FieldDesc* TypeTable::field(TypeId structType, const string& name) const {
+    for (const FieldDesc& f : types[structType].fields) {
+        if (f.name == name) return &f;
+    }
+    return nullptr;
+}
+
+int TypeTable::frameSize(TypeId id) const {
+    const TypeDesc& desc = types[id];
+    switch (desc.kind) {
+        case TypeDesc::SCALAR:
+            return (desc.scalar == Type::I32 || desc.scalar == Type::U32 || desc.scalar == Type::F32) ? 4 : 8;
+        case TypeDesc::ARRAY:
+        case TypeDesc::STRUCT:
+            return static_cast<int>(desc.size);
+        case TypeDesc::UNKNOWN:
+            break;
+    }
+    return 8;
+}
+
+void TypeTable::writeLayoutReport(ostream& os) const {
+    for (TypeId id : structOrder) {
+        const TypeDesc& desc = types[id];
+        os << "struct " << desc.name << ": size " << desc.size << ", align " << desc.align
+           << ", padding " << desc.padding << "\n";
+
+        // Campos en orden de memoria
+        vector<const FieldDesc*> byOffset;
+        for (const FieldDesc& f : desc.fields) byOffset.push_back(&f);
+        stable_sort(byOffset.begin(), byOffset.end(), [](const FieldDesc* a, const FieldDesc* b) {
+            return a->offset < b->offset;
+        });
+        for (const FieldDesc* f : byOffset) {
+            os << "  " << f->offset << "\t" << f->name << ": " << types[f->type].name
+               << " (" << types[f->type].size << ")\n";
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef TYPE_TABLE_H
+#define TYPE_TABLE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "semantic_types.h"
+
+using namespace std;
+
+// Campo de un struct: offset en bytes desde el inicio del struct
+struct FieldDesc {
+    string name;
+    TypeId type;
+    uint32_t offset;
+};
+
+// Descriptor estructurado de un tipo
+struct TypeDesc {
+    enum Kind : uint8_t { UNKNOWN, SCALAR, ARRAY, STRUCT };
+
+    Kind kind = UNKNOWN;
+    Type::TType scalar = Type::NOTYPE; // SCALAR
+    TypeId element = kNoType;          // ARRAY: tipo de cada elemento
+    uint32_t length = 0;               // ARRAY: cantidad de elementos
+    uint32_t size = 8;                 // bytes en memoria (campo, elemento)
+    uint32_t align = 8;
+    string name;                       // nombre canónico ("i32", "i64[4]", "Point")
+    vector<FieldDesc> fields;          // STRUCT, en orden de declaración
+    uint32_t padding = 0;              // STRUCT: bytes de relleno (internos y finales)
+};
+
+// ===========================================================
+//  Tabla de tipos de un programa.
+//  Cada tipo distinto (escalar, arreglo T[N] o struct) tiene un
+//  descriptor y un TypeId. Los nombres escritos en el fuente
+//  ("i32[5]", un alias, un struct) se resuelven y se parsean una
+//  sola vez: intern memoriza el TypeId de cada escritura. Los
+//  alias se registran primero; los structs se declaran todos y
+//  luego layoutStructs calcula offsets y tamaños. El largo de
+//  un arreglo puede ser un literal o el nombre de una constante
+//  (defineConstant, antes de internar tipos que la usen).
+//
+//  Layout: cada campo queda en un offset múltiplo de su
+//  alineación natural y el tamaño del struct se redondea a la
+//  alineación del struct (la mayor de sus campos), como en C.
+//  Con reorderFields los campos se ubican de mayor a menor
+//  alineación, lo que deja el padding mínimo; el orden es
+//  estable, así que campos declarados juntos (que suelen
+//  usarse juntos) siguen contiguos en la misma línea de cache.
+// ===========================================================
+
+class TypeTable {
+private:
+    vector<TypeDesc> types;
+    unordered_map<string, TypeId> ids;      // escritura o nombre canónico -> TypeId
+    unordered_map<string, string> aliases;  // alias -> tipo escrito
+    unordered_map<string, int64_t> constants; // const items (largos de arreglo)
+    unordered_map<TypeId, vector<pair<string, string>>> pendingFields; // structs sin layout
+    vector<TypeId> pendingOrder;
+    vector<TypeId> structOrder;             // structs en orden de declaración
+    bool reorderFields = false;
+
+    TypeId add(TypeDesc desc);
+    TypeId addScalar(const char* name, Type::TType tt, uint32_t size);
+    TypeId arrayOf(TypeId element, uint32_t length);
+    uint32_t arrayLength(const string& spelled) const;
+    TypeId resolve(const string& spelled, int depth);
+    void layout(TypeId id, vector<uint8_t>& state);
+
+public:
+    TypeTable();
+
+    // Vuelve a dejar sólo los escalares (conserva el modo de layout)
+    void clear();
+
+    // Ubicar campos por alineación decreciente (se aplica en layoutStructs)
+    void setFieldReordering(bool enable) { reorderFields = enable; }
+
+    void addAlias(const string& alias, const string& target);
+    void defineConstant(const string& name, int64_t value) { constants[name] = value; }
+    // Declara un struct; sus campos se resuelven en layoutStructs
+    TypeId declareStruct(const string& name, const vector<pair<string, string>>& fields);
+    // Calcula el layout de los structs declarados (lanza si un struct se contiene a sí mismo)
+    void layoutStructs();
+
+    // TypeId de un tipo escrito en el fuente; kNoType si no existe
+    TypeId intern(const string& spelled);
+
+    const TypeDesc& get(TypeId id) const { return types[id]; }
+    const FieldDesc* field(TypeId structType, const string& name) const;
+
+    // Bytes de una variable local: los escalares de 32 bits se guardan con
+    // movl y el resto con movq; arreglos y structs ocupan su tamaño
+    int frameSize(TypeId id) const;
+
+    size_t size() const { return types.size(); }
+
+    // Tamaño, alineación, padding y offsets de cada struct
+    void writeLayoutReport(ostream& os) const;
+};
+
+#endif // TYPE_TABLE_H
@@ -1,6 +1,7 @@
 #include "visitor.h"
 
 #include "ast.h"
+#include "const_eval.h"
 
 #include <stdexcept>
 #include <string>
@@ -21,19 +22,18 @@ Type::TType resolve_type(const string& name) {
     return tt;
 }
 
-struct StructLayout {
-    int size;
-    std::unordered_map<std::string, int> offsets;
-    std::unordered_map<std::string, std::string> types;
-};
-static std::unordered_map<std::string, StructLayout> globalStructLayouts;
-static std::unordered_map<std::string, std::string> globalTypeAliases;
+bool is_float(Type::TType t) {
+    return t == Type::F32 || t == Type::F64;
+}
 
-string resolve_alias(string name) {
-    while (globalTypeAliases.count(name)) {
-        name = globalTypeAliases[name];
+// Dirección del elemento %rcx del arreglo en %rax
+void emit_element_address(std::ostream& out, uint32_t stride) {
+    if (stride == 1 || stride == 2 || stride == 4 || stride == 8) {
+        out << " leaq (%rax, %rcx, " << stride << "), %rax\n";
+    } else {
+        out << " imulq $" << stride << ", %rcx\n";
+        out << " addq %rcx, %rax\n";
     }
-    return name;
 }
 }
 
@@ -48,19 +48,69 @@ string GenCodeVisitor::makeLabel(const string& base) {
     return ".L_" + base + "_" + std::to_string(nextLabelId++);
 }
 
-SymbolInfo GenCodeVisitor::declareLocal(const string& name, const SymbolInfo& infoTemplate) {
+// Literal entero o expresión que el checker resolvió en compilación
+bool GenCodeVisitor::constantValue(Exp* exp, int64_t& value) const {
+    if (NumberExp* num = as<NumberExp>(exp)) {
+        value = num->value;
+        return true;
+    }
+    auto it = typeChecker.constantValues.find(exp);
+    if (it == typeChecker.constantValues.end()) return false;
+    value = it->second;
+    return true;
+}
+
+// Reserva bytes (múltiplo de 8) debajo del último slot vivo; devuelve el
+// offset más bajo. El checker calculó el pico con la misma disciplina
+int GenCodeVisitor::allocateFrame(int bytes) {
+    int offset = nextStackOffset - bytes + 8;
+    nextStackOffset -= bytes;
+    if (-offset > frameBytes) {
+        throw std::runtime_error("Frame de " + currentFunctionName + " excede lo reservado");
+    }
+    return offset;
+}
+
+// Libera todo lo reservado después de mark. Una entrada del cache DAG que
+// apunte a esos slots quedaría pisada por la próxima reserva
+void GenCodeVisitor::releaseFrame(int mark) {
+    nextStackOffset = mark;
+    for (auto it = dagCache.begin(); it != dagCache.end();) {
+        if (it->second.offset <= mark) {
+            it = dagCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Los temporales de una sentencia mueren con ella; un let conserva su
+// variable hasta el cierre del scope (libera sólo los de su inicializador)
+void GenCodeVisitor::emitStatement(Stm* stm) {
+    int mark = nextStackOffset;
+    stm->accept(this);
+    if (!as<LetStm>(stm)) releaseFrame(mark);
+}
+
+SymbolInfo GenCodeVisitor::declareLocal(SymbolId name, const SymbolInfo& infoTemplate) {
     SymbolInfo info = infoTemplate;
-    info.offset = nextStackOffset;
-    nextStackOffset -= 8;
+    info.offset = allocateFrame(8);
     symbols.declare(name, info);
     return info;
 }
 
-const SymbolInfo* GenCodeVisitor::lookupSymbol(const string& name) const {
+// Bytes por elemento del arreglo guardado en la variable (4 si no es un arreglo)
+uint32_t GenCodeVisitor::elementSize(const SymbolInfo& info) const {
+    const TypeTable& types = typeChecker.typeTable();
+    const TypeDesc& desc = types.get(info.typeId);
+    return desc.kind == TypeDesc::ARRAY ? types.get(desc.element).size : 4;
+}
+
+const SymbolInfo* GenCodeVisitor::lookupSymbol(SymbolId name) const {
     return symbols.lookup(name);
 }
 
-SymbolInfo* GenCodeVisitor::lookupSymbol(const string& name) {
+SymbolInfo* GenCodeVisitor::lookupSymbol(SymbolId name) {
     return symbols.lookup(name);
 }
 
@@ -68,72 +118,50 @@ SymbolInfo* GenCodeVisitor::lookupSymbol(const string& name) {
 // IMPLEMENTACIÓN DE OPTIMIZACIÓN DAG
 // =============================================================================
 
-// Genera una firma única para una expresión (para el cache DAG)
-std::string GenCodeVisitor::generateExprSignature(Exp* exp) {
-    if (!exp) return "";
-    
-    if (NumberExp* num = dynamic_cast<NumberExp*>(exp)) {
-        return "NUM:" + std::to_string(num->value);
-    }
-    
-    if (BoolExp* b = dynamic_cast<BoolExp*>(exp)) {
-        return "BOOL:" + std::to_string(b->valor ? 1 : 0);
+// Variables leídas por una expresión apta para CSE (sólo ids y binarias)
+static void collectReads(Exp* exp, std::vector<SymbolId>& reads) {
+    if (IdExp* id = as<IdExp>(exp)) {
+        reads.push_back(id->sym);
+    } else if (BinaryExp* bin = as<BinaryExp>(exp)) {
+        collectReads(bin->left, reads);
+        collectReads(bin->right, reads);
     }
-    
-    if (IdExp* id = dynamic_cast<IdExp*>(exp)) {
-        return "ID:" + id->value;
-    }
-    
-    if (BinaryExp* bin = dynamic_cast<BinaryExp*>(exp)) {
-        string leftSig = generateExprSignature(bin->left);
-        string rightSig = generateExprSignature(bin->right);
-        string opStr;
-        switch (bin->op) {
-            case PLUS_OP: opStr = "+"; break;
-            case MINUS_OP: opStr = "-"; break;
-            case MUL_OP: opStr = "*"; break;
-            case DIV_OP: opStr = "/"; break;
-            default: return ""; // No cachear otras operaciones
-        }
-        return "BIN:(" + leftSig + ")" + opStr + "(" + rightSig + ")";
-    }
-    
-    // No cachear otras expresiones (llamadas a funciones, arrays, etc.)
-    return "";
 }
 
-// Busca una expresión en el cache DAG
-DAGCacheEntry* GenCodeVisitor::lookupDAGCache(const std::string& signature) {
-    if (!dagEnabled || signature.empty()) return nullptr;
+// Busca una expresión en el cache DAG. La clave es el hash estructural
+// calculado al construir el nodo; sameStructure descarta colisiones
+DAGCacheEntry* GenCodeVisitor::lookupDAGCache(Exp* exp) {
+    // Una expresión constante se emite como inmediato: no vale la pena cachearla
+    if (!dagEnabled || !exp || !exp->hash || typeChecker.constantValues.count(exp)) return nullptr;
     
-    auto it = dagCache.find(signature);
-    if (it != dagCache.end()) {
+    auto it = dagCache.find(exp->hash);
+    if (it != dagCache.end() && Exp::sameStructure(it->second.exp, exp)) {
         return &(it->second);
     }
     return nullptr;
 }
 
 // Guarda una expresión en el cache DAG
-void GenCodeVisitor::saveToDAGCache(const std::string& signature, int offset, Type::TType type) {
-    if (!dagEnabled || signature.empty()) return;
+void GenCodeVisitor::saveToDAGCache(Exp* exp, int offset, Type::TType type) {
+    if (!dagEnabled || !exp || !exp->hash || typeChecker.constantValues.count(exp)) return;
     
     DAGCacheEntry entry;
     entry.offset = offset;
     entry.type = type;
-    entry.signature = signature;
-    dagCache[signature] = entry;
+    entry.exp = exp;
+    collectReads(exp, entry.reads);
+    dagCache[exp->hash] = entry;
 }
 
 // Invalida entradas del cache que dependen de una variable
-void GenCodeVisitor::invalidateDAGCache(const std::string& varName) {
+void GenCodeVisitor::invalidateDAGCache(SymbolId var) {
     if (!dagEnabled) return;
     
-    string pattern = "ID:" + varName;
-    
-    // Eliminar todas las entradas que contienen esta variable
+    // Eliminar todas las entradas que leen esta variable
     auto it = dagCache.begin();
     while (it != dagCache.end()) {
-        if (it->first.find(pattern) != string::npos) {
+        const std::vector<SymbolId>& reads = it->second.reads;
+        if (std::find(reads.begin(), reads.end(), var) != reads.end()) {
             it = dagCache.erase(it);
         } else {
             ++it;
@@ -270,10 +298,9 @@ int GenCodeVisitor::visit(FunDec* function) {
     if (it != frameReservation.end()) {
         reservedSlots = it->second;
     }
-    // Agregar slots extra para cache DAG de subexpresiones
-    reservedSlots += 10; // Espacio extra para subexpresiones cacheadas
-    
-    int frameBytes = reservedSlots * 8;
+    // El cache DAG reutiliza los slots de las variables: no necesita extra.
+    // Múltiplo de 16 para que %rsp quede alineado en cada call
+    frameBytes = (reservedSlots * 8 + 15) / 16 * 16;
     if (frameBytes > 0) {
         out << " subq $" << frameBytes << ", %rsp\n";
     }
@@ -283,8 +310,9 @@ int GenCodeVisitor::visit(FunDec* function) {
         SymbolInfo tmpl;
         tmpl.isMutable = false;
         tmpl.initialized = true;
-        tmpl.type = resolve_type(function->Tparametros[idx]);
-        tmpl.typeName = function->Tparametros[idx];
+        tmpl.type = function->paramTypes[idx].scalar;
+        tmpl.size = function->paramTypes[idx].size;
+        tmpl.typeId = function->paramTypes[idx].id;
         SymbolInfo info = declareLocal(function->Nparametros[idx], tmpl);
         out << " movq " << kArgRegisters[idx] << ", " << info.offset << "(%rbp)\n";
     }
@@ -317,20 +345,27 @@ int GenCodeVisitor::visit(Body* body) {
     }
     for (auto stmt : body->stmlist) {
         if (stmt) {
-            stmt->accept(this);
+            emitStatement(stmt);
         }
     }
     return 0;
 }
 
 int GenCodeVisitor::visit(BlockStm* block) {
+    std::ostream& targetOut = bufferingOutput ? tempOutput : out;
+
     symbols.push_scope();
+    int mark = nextStackOffset;
     for (auto stmt : block->statements) {
         if (stmt) {
-            stmt->accept(this);
+            if (sourceLines) {
+                targetOut << " # linea " << sourceLines->locate(stmt->offset).line << "\n";
+            }
+            emitStatement(stmt);
         }
     }
     symbols.pop_scope();
+    releaseFrame(mark);
     return 0;
 }
 
@@ -338,8 +373,8 @@ int GenCodeVisitor::visit(LetStm* letStmt) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
 
     if (!insideFunction) {
-        if (globalSymbols.find(letStmt->name) == globalSymbols.end()) {
-            globalSymbols.emplace(letStmt->name, letStmt->name);
+        if (globalSymbols.find(letStmt->sym) == globalSymbols.end()) {
+            globalSymbols.emplace(letStmt->sym, letStmt->name());
         }
         return 0;
     }
@@ -347,33 +382,19 @@ int GenCodeVisitor::visit(LetStm* letStmt) {
     SymbolInfo tmpl;
     tmpl.isMutable = letStmt->mutable_flag;
     tmpl.initialized = letStmt->init != nullptr;
-    tmpl.type = resolve_type(letStmt->type_name);
-    tmpl.typeName = letStmt->type_name;
-
-    int size = 8;
-    string typeName = resolve_alias(letStmt->type_name);
-    if (typeName.find("[") != string::npos) {
-        size_t open = typeName.find("[");
-        size_t close = typeName.find("]");
-        int count = stoi(typeName.substr(open + 1, close - open - 1));
-        size = count * 4;
-    } else if (globalStructLayouts.count(typeName)) {
-        size = globalStructLayouts[typeName].size;
-    } else if (tmpl.type == Type::F32 || tmpl.type == Type::I32 || tmpl.type == Type::U32) {
-        size = 4;
-    }
-
-    int alignedSize = (size + 7) / 8 * 8;
-    int offset = nextStackOffset - alignedSize + 8;
-    nextStackOffset -= alignedSize;
+    tmpl.type = letStmt->resolved.scalar;
+    tmpl.size = letStmt->resolved.size;
+    tmpl.typeId = letStmt->resolved.id;
 
-    tmpl.offset = offset;
-    symbols.declare(letStmt->name, tmpl);
+    int size = tmpl.size;
+    tmpl.offset = allocateFrame((size + 7) / 8 * 8);
+    symbols.declare(letStmt->sym, tmpl);
+    // Los temporales del inicializador se liberan al terminar el let
+    int mark = nextStackOffset;
 
     if (letStmt->init) {
         // Verificar si la expresión de inicialización está en cache DAG
-        string signature = generateExprSignature(letStmt->init);
-        DAGCacheEntry* cached = lookupDAGCache(signature);
+        DAGCacheEntry* cached = lookupDAGCache(letStmt->init);
         
         if (cached) {
             // ¡Reutilizar valor del cache DAG!
@@ -389,12 +410,12 @@ int GenCodeVisitor::visit(LetStm* letStmt) {
             letStmt->init->accept(this);
             
             // Guardar en cache DAG si es una expresión binaria
-            if (!signature.empty() && dynamic_cast<BinaryExp*>(letStmt->init)) {
-                saveToDAGCache(signature, tmpl.offset, tmpl.type);
+            if (as<BinaryExp>(letStmt->init)) {
+                saveToDAGCache(letStmt->init, tmpl.offset, tmpl.type);
             }
         }
         
-        Type::TType rhsType = lastType;
+        Type::TType rhsType = letStmt->init->type;
 
         if (tmpl.type == Type::F32 && (rhsType == Type::F64 || rhsType == Type::NOTYPE)) {
             targetOut << " movq %rax, %xmm0\n";
@@ -419,6 +440,7 @@ int GenCodeVisitor::visit(LetStm* letStmt) {
         }
     }
 
+    releaseFrame(mark);
     return 0;
 }
 
@@ -478,13 +500,14 @@ int GenCodeVisitor::visit(ForStm* forStmt) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
 
     symbols.push_scope();
+    int mark = nextStackOffset;
     clearDAGCache();
 
     SymbolInfo tmpl;
     tmpl.isMutable = true;
     tmpl.initialized = true;
     tmpl.type = Type::I64;
-    SymbolInfo iterInfo = declareLocal(forStmt->iteratorName, tmpl);
+    SymbolInfo iterInfo = declareLocal(forStmt->iterator, tmpl);
 
     if (forStmt->start) {
         forStmt->start->accept(this);
@@ -518,6 +541,7 @@ int GenCodeVisitor::visit(ForStm* forStmt) {
     targetOut << endLabel << ":\n";
 
     symbols.pop_scope();
+    releaseFrame(mark);
     clearDAGCache();
     return 0;
 }
@@ -525,15 +549,17 @@ int GenCodeVisitor::visit(ForStm* forStmt) {
 int GenCodeVisitor::visit(PrintStm* printStmt) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
 
+    Type::TType valueType = Type::NOTYPE;
     if (!printStmt->e) {
         targetOut << " movq $0, %rax\n";
     } else {
         printStmt->e->accept(this);
+        valueType = printStmt->e->type;
     }
 
-    if (lastType == Type::F32 || lastType == Type::F64) {
+    if (is_float(valueType)) {
         targetOut << " movq %rax, %xmm0\n";
-        if (lastType == Type::F32) {
+        if (valueType == Type::F32) {
             targetOut << " cvtss2sd %xmm0, %xmm0\n";
         }
         targetOut << " leaq print_float_fmt(%rip), %rdi\n";
@@ -551,7 +577,7 @@ int GenCodeVisitor::visit(PrintStm* printStmt) {
 int GenCodeVisitor::visit(AssignStm* assignStmt) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
 
-    if (assignStmt->id == "_") {
+    if (assignStmt->id() == "_") {
         if (assignStmt->e) {
             assignStmt->e->accept(this);
         }
@@ -559,27 +585,27 @@ int GenCodeVisitor::visit(AssignStm* assignStmt) {
     }
 
     if (!assignStmt->e) {
-        throw std::runtime_error("Asignación sin expresión para " + assignStmt->id);
+        throw std::runtime_error("Asignación sin expresión para " + assignStmt->id());
     }
 
     assignStmt->e->accept(this);
     
     // IMPORTANTE: Invalidar cache DAG cuando se modifica una variable
-    invalidateDAGCache(assignStmt->id);
+    invalidateDAGCache(assignStmt->sym);
 
-    if (auto* info = lookupSymbol(assignStmt->id)) {
+    if (auto* info = lookupSymbol(assignStmt->sym)) {
         info->initialized = true;
         targetOut << " movq %rax, " << info->offset << "(%rbp)\n";
         return 0;
     }
 
-    auto globalIt = globalSymbols.find(assignStmt->id);
+    auto globalIt = globalSymbols.find(assignStmt->sym);
     if (globalIt != globalSymbols.end()) {
         targetOut << " movq %rax, " << globalIt->second << "(%rip)\n";
         return 0;
     }
 
-    throw std::runtime_error("Identificador no declarado: " + assignStmt->id);
+    throw std::runtime_error("Identificador no declarado: " + assignStmt->id());
 }
 
 int GenCodeVisitor::visit(ReturnStm* returnStmt) {
@@ -597,8 +623,9 @@ int GenCodeVisitor::visit(ReturnStm* returnStmt) {
 int GenCodeVisitor::visit(VarDec* varDec) {
     if (!insideFunction) {
         for (const auto& name : varDec->variables) {
-            if (globalSymbols.find(name) == globalSymbols.end()) {
-                globalSymbols.emplace(name, name);
+            SymbolId sym = global_interner().intern(name);
+            if (globalSymbols.find(sym) == globalSymbols.end()) {
+                globalSymbols.emplace(sym, name);
             }
         }
         return 0;
@@ -609,41 +636,33 @@ int GenCodeVisitor::visit(VarDec* varDec) {
         tmpl.isMutable = true;
         tmpl.initialized = false;
         tmpl.type = resolve_type(varDec->tipo);
-        declareLocal(name, tmpl);
+        tmpl.size = (tmpl.type == Type::I32 || tmpl.type == Type::U32 || tmpl.type == Type::F32) ? 4 : 8;
+        declareLocal(global_interner().intern(name), tmpl);
     }
     return 0;
 }
 
 int GenCodeVisitor::visit(BinaryExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
+    int64_t constant;
+    if (constantValue(exp, constant)) {
+        targetOut << " movq $" << constant << ", %rax\n";
+        return 0;
+    }
 
     if (exp->op == ASSIGN_OP) {
-        if (IdExp* idExp = dynamic_cast<IdExp*>(exp->left)) {
-            string name = idExp->value;
+        if (IdExp* idExp = as<IdExp>(exp->left)) {
+            SymbolId name = idExp->sym;
 
             exp->right->accept(this);
-            Type::TType rhsType = lastType;
+            Type::TType rhsType = exp->right->type;
             
             // Invalidar cache DAG para esta variable
             invalidateDAGCache(name);
 
             if (auto* info = lookupSymbol(name)) {
                 info->initialized = true;
-
-                string typeName = resolve_alias(info->typeName);
-                int size = 8;
-                if (typeName.find("[") != string::npos) {
-                    size_t open = typeName.find("[");
-                    size_t close = typeName.find("]");
-                    int count = stoi(typeName.substr(open + 1, close - open - 1));
-                    size = count * 4;
-                } else if (globalStructLayouts.count(typeName)) {
-                    size = globalStructLayouts[typeName].size;
-                } else if (info->type == Type::F32) {
-                    size = 4;
-                } else if (info->type == Type::I32 || info->type == Type::U32) {
-                    size = 4;
-                }
+                int size = info->size;
 
                 if (info->type == Type::F32 && (rhsType == Type::F64 || rhsType == Type::NOTYPE)) {
                     targetOut << " movq %rax, %xmm0\n";
@@ -673,20 +692,16 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
                 targetOut << " movq %rax, " << globalIt->second << "(%rip)\n";
                 return 0;
             }
-            throw std::runtime_error("Identificador no declarado: " + name);
+            throw std::runtime_error("Identificador no declarado: " + idExp->value());
 
-        } else if (ArrayAccessExp* arrExp = dynamic_cast<ArrayAccessExp*>(exp->left)) {
-            IdExp* idArr = dynamic_cast<IdExp*>(arrExp->array);
+        } else if (ArrayAccessExp* arrExp = as<ArrayAccessExp>(exp->left)) {
+            IdExp* idArr = as<IdExp>(arrExp->array);
             if (!idArr) throw std::runtime_error("Solo se soporta asignación a arrays con nombre directo");
 
-            auto* info = lookupSymbol(idArr->value);
-            if (!info) throw std::runtime_error("Array no declarado: " + idArr->value);
+            auto* info = lookupSymbol(idArr->sym);
+            if (!info) throw std::runtime_error("Array no declarado: " + idArr->value());
 
-            string typeName = resolve_alias(info->typeName);
-            int elemSize = 4;
-            if (typeName.find("i64") != string::npos || typeName.find("u64") != string::npos || typeName.find("f64") != string::npos) {
-                elemSize = 8;
-            }
+            uint32_t elemSize = elementSize(*info);
 
             targetOut << " leaq " << info->offset << "(%rbp), %rax\n";
             targetOut << " pushq %rax\n";
@@ -695,16 +710,16 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
             targetOut << " movq %rax, %rcx\n";
             targetOut << " popq %rax\n";
 
-            targetOut << " leaq (%rax, %rcx, " << elemSize << "), %rax\n";
+            emit_element_address(targetOut, elemSize);
             targetOut << " pushq %rax\n";
 
             exp->right->accept(this);
 
             targetOut << " popq %rdi\n";
-            if (elemSize == 4) {
-                targetOut << " movl %eax, (%rdi)\n";
-            } else {
+            if (elemSize == 8) {
                 targetOut << " movq %rax, (%rdi)\n";
+            } else {
+                targetOut << " movl %eax, (%rdi)\n";
             }
 
             return 0;
@@ -732,24 +747,27 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
     }
 
     // OPTIMIZACIÓN PEEPHOLE: Si el operando derecho es una constante, generar código directo
-    NumberExp* rightNum = dynamic_cast<NumberExp*>(exp->right);
-    if (rightNum && (exp->op == PLUS_OP || exp->op == MINUS_OP || exp->op == MUL_OP)) {
+    int64_t rightValue = 0;
+    bool rightConstant = constantValue(exp->right, rightValue);
+    if (rightConstant && (exp->op == PLUS_OP || exp->op == MINUS_OP || exp->op == MUL_OP)) {
         exp->left->accept(this);
-        Type::TType leftType = lastType;
         
-        if (leftType != Type::F32 && leftType != Type::F64) {
+        if (!is_float(exp->left->type)) {
+            // addq/subq/imulq sólo aceptan inmediatos de 32 bits con signo
+            string operand = "$" + to_string(rightValue);
+            if (rightValue < INT32_MIN || rightValue > INT32_MAX) {
+                targetOut << " movabsq $" << rightValue << ", %rcx\n";
+                operand = "%rcx";
+            }
             switch (exp->op) {
                 case PLUS_OP:
-                    targetOut << " addq $" << rightNum->value << ", %rax\n";
-                    lastType = Type::I64;
+                    targetOut << " addq " << operand << ", %rax\n";
                     return 0;
                 case MINUS_OP:
-                    targetOut << " subq $" << rightNum->value << ", %rax\n";
-                    lastType = Type::I64;
+                    targetOut << " subq " << operand << ", %rax\n";
                     return 0;
                 case MUL_OP:
-                    targetOut << " imulq $" << rightNum->value << ", %rax\n";
-                    lastType = Type::I64;
+                    targetOut << " imulq " << operand << ", %rax\n";
                     return 0;
                 default:
                     break;
@@ -759,14 +777,14 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
 
     // Código general para otras expresiones
     exp->left->accept(this);
-    Type::TType leftType = lastType;
+    Type::TType leftType = exp->left->type;
     targetOut << " pushq %rax\n";
     exp->right->accept(this);
-    Type::TType rightType = lastType;
+    Type::TType rightType = exp->right->type;
     targetOut << " movq %rax, %rcx\n";
     targetOut << " popq %rax\n";
 
-    bool isFloat = (leftType == Type::F32 || leftType == Type::F64 || rightType == Type::F32 || rightType == Type::F64);
+    bool isFloat = is_float(leftType) || is_float(rightType);
 
     if (isFloat) {
         targetOut << " movq %rax, %xmm0\n";
@@ -780,7 +798,6 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
                 case DIV_OP: targetOut << " divss %xmm1, %xmm0\n"; break;
                 default: throw std::runtime_error("Float op not supported");
             }
-            lastType = Type::F32;
         } else {
             if (leftType == Type::F32) targetOut << " cvtss2sd %xmm0, %xmm0\n";
             if (rightType == Type::F32) targetOut << " cvtss2sd %xmm1, %xmm1\n";
@@ -792,7 +809,6 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
                 case DIV_OP: targetOut << " divsd %xmm1, %xmm0\n"; break;
                 default: throw std::runtime_error("Float op not supported");
             }
-            lastType = Type::F64;
         }
         targetOut << " movq %xmm0, %rax\n";
         return 0;
@@ -853,7 +869,6 @@ int GenCodeVisitor::visit(BinaryExp* exp) {
         default:
             throw std::runtime_error("Operador binario no soportado");
     }
-    lastType = Type::I64;
     return 0;
 }
 
@@ -861,7 +876,6 @@ int GenCodeVisitor::visit(NumberExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
 
     targetOut << " movq $" << exp->value << ", %rax\n";
-    lastType = Type::I64;
     return 0;
 }
 
@@ -874,19 +888,13 @@ int GenCodeVisitor::visit(BoolExp* exp) {
 
 int GenCodeVisitor::visit(IdExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
-    if (const auto* info = lookupSymbol(exp->value)) {
-        string typeName = resolve_alias(info->typeName);
-        int size = 8;
-        if (typeName.find("[") != string::npos) {
-            size_t open = typeName.find("[");
-            size_t close = typeName.find("]");
-            int count = stoi(typeName.substr(open + 1, close - open - 1));
-            size = count * 4;
-        } else if (globalStructLayouts.count(typeName)) {
-            size = globalStructLayouts[typeName].size;
-        }
-
-        if (size > 8) {
+    int64_t constant;
+    if (constantValue(exp, constant)) {
+        targetOut << " movq $" << constant << ", %rax\n";
+        return 0;
+    }
+    if (const auto* info = lookupSymbol(exp->sym)) {
+        if (info->size > 8) {
             targetOut << " leaq " << info->offset << "(%rbp), %rax\n";
         } else {
             if (info->type == Type::F32 || info->type == Type::I32 || info->type == Type::U32) {
@@ -895,23 +903,26 @@ int GenCodeVisitor::visit(IdExp* exp) {
                 targetOut << " movq " << info->offset << "(%rbp), %rax\n";
             }
         }
-        lastType = info->type;
         return 0;
     }
 
-    auto it = globalSymbols.find(exp->value);
+    auto it = globalSymbols.find(exp->sym);
     if (it != globalSymbols.end()) {
         targetOut << " movq " << it->second << "(%rip), %rax\n";
-        lastType = Type::I64;
         return 0;
     }
 
-    throw std::runtime_error("Identificador no declarado: " + exp->value);
+    throw std::runtime_error("Identificador no declarado: " + exp->value());
 }
 
 int GenCodeVisitor::visit(FcallExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
-    vector<Exp*> args(exp->argumentos.begin(), exp->argumentos.end());
+    int64_t constant;
+    if (constantValue(exp, constant)) {
+        targetOut << " movq $" << constant << ", %rax\n";
+        return 0;
+    }
+    const auto& args = exp->argumentos;
     std::size_t totalArgs = args.size();
     std::size_t stackArgs = totalArgs > kArgRegisters.size() ? totalArgs - kArgRegisters.size() : 0;
 
@@ -936,7 +947,7 @@ int GenCodeVisitor::visit(FcallExp* exp) {
         }
     }
 
-    targetOut << " call " << exp->nombre << "\n";
+    targetOut << " call " << exp->nombre() << "\n";
 
     if (stackAdjust > 0) {
         targetOut << " addq $" << stackAdjust << ", %rsp\n";
@@ -944,35 +955,19 @@ int GenCodeVisitor::visit(FcallExp* exp) {
     return 0;
 }
 
-int GenCodeVisitor::visit(StructDec* sd) {
-    StructLayout layout;
-    int currentOffset = 0;
-    for (auto& field : sd->fields) {
-        layout.offsets[field.first] = currentOffset;
-        layout.types[field.first] = field.second;
-        string type = field.second;
-        int size = 8;
-        if (type.find("[") != string::npos) {
-            size_t open = type.find("[");
-            size_t close = type.find("]");
-            int count = stoi(type.substr(open + 1, close - open - 1));
-            size = count * 4;
-        } else if (type == "i32" || type == "bool" || type == "u32" || type == "f32") {
-            size = 4;
-        }
-        layout.offsets[field.first] = currentOffset;
-        currentOffset += size;
-    }
-    layout.size = currentOffset;
-    globalStructLayouts[sd->name] = layout;
+// El layout de cada struct y los alias viven en la TypeTable que arma
+// TypeCheckerVisitor antes de generar
+int GenCodeVisitor::visit(StructDec*) {
     return 0;
 }
 
 int GenCodeVisitor::visit(ArrayAccessExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
-    if (IdExp* id = dynamic_cast<IdExp*>(exp->array)) {
-        if (const auto* info = lookupSymbol(id->value)) {
+    uint32_t elemSize = 4;
+    if (IdExp* id = as<IdExp>(exp->array)) {
+        if (const auto* info = lookupSymbol(id->sym)) {
             targetOut << " leaq " << info->offset << "(%rbp), %rax\n";
+            elemSize = elementSize(*info);
         } else {
             throw std::runtime_error("Array global no soportado");
         }
@@ -985,24 +980,26 @@ int GenCodeVisitor::visit(ArrayAccessExp* exp) {
     targetOut << " movq %rax, %rcx\n";
     targetOut << " popq %rax\n";
 
-    targetOut << " leaq (%rax, %rcx, 4), %rax\n";
-    targetOut << " movl (%rax), %eax\n";
-    targetOut << " cltq\n";
+    emit_element_address(targetOut, elemSize);
+    if (elemSize == 8) {
+        targetOut << " movq (%rax), %rax\n";
+    } else if (elemSize == 4) {
+        targetOut << " movl (%rax), %eax\n";
+        targetOut << " cltq\n";
+    }
+    // Otros tamaños (structs): queda la dirección del elemento, como en IdExp
     return 0;
 }
 
 int GenCodeVisitor::visit(FieldAccessExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
-    if (IdExp* id = dynamic_cast<IdExp*>(exp->object)) {
-        if (const auto* info = lookupSymbol(id->value)) {
-            targetOut << " leaq " << info->offset << "(%rbp), %rax\n";
-            string typeName = resolve_alias(info->typeName);
-            if (globalStructLayouts.count(typeName)) {
-                int offset = globalStructLayouts[typeName].offsets[exp->field];
-                string fieldType = globalStructLayouts[typeName].types[exp->field];
-                targetOut << " addq $" << offset << ", %rax\n";
+    if (IdExp* id = as<IdExp>(exp->object)) {
+        if (const auto* info = lookupSymbol(id->sym)) {
+            if (const FieldDesc* field = typeChecker.typeTable().field(info->typeId, exp->field)) {
+                targetOut << " leaq " << info->offset << "(%rbp), %rax\n";
+                targetOut << " addq $" << field->offset << ", %rax\n";
 
-                if (fieldType == "i64" || fieldType == "u64" || fieldType == "f64") {
+                if (typeChecker.typeTable().get(field->type).size == 8) {
                     targetOut << " movq (%rax), %rax\n";
                 } else {
                     targetOut << " movl (%rax), %eax\n";
@@ -1017,28 +1014,24 @@ int GenCodeVisitor::visit(FieldAccessExp* exp) {
 
 int GenCodeVisitor::visit(StructInitExp* exp) {
     std::ostream& targetOut = bufferingOutput ? tempOutput : out;
-    string resolvedName = resolve_alias(exp->name);
-    if (globalStructLayouts.count(resolvedName)) {
-        auto& layout = globalStructLayouts[resolvedName];
-        int size = layout.size;
-
-        int alignedSize = (size + 7) / 8 * 8;
-
-        int structBaseOffset = nextStackOffset - alignedSize + 8;
-        nextStackOffset -= alignedSize;
+    const TypeTable& types = typeChecker.typeTable();
+    const TypeDesc& layout = types.get(exp->structType);
+    if (layout.kind == TypeDesc::STRUCT) {
+        int size = static_cast<int>(layout.size);
+        int structBaseOffset = allocateFrame((size + 7) / 8 * 8);
 
         for (auto& field : exp->fields) {
-            string fname = field.first;
-            Exp* expr = field.second;
-            int fieldOffset = layout.offsets[fname];
-            string ftype = layout.types[fname];
+            const FieldDesc* desc = types.field(exp->structType, field.first);
+            if (!desc) {
+                throw std::runtime_error("El struct " + layout.name + " no tiene campo " + field.first);
+            }
 
-            expr->accept(this);
+            field.second->accept(this);
 
-            if (ftype == "i32" || ftype == "bool") {
-                targetOut << " movl %eax, " << (structBaseOffset + fieldOffset) << "(%rbp)\n";
+            if (types.get(desc->type).size == 4) {
+                targetOut << " movl %eax, " << (structBaseOffset + static_cast<int>(desc->offset)) << "(%rbp)\n";
             } else {
-                targetOut << " movq %rax, " << (structBaseOffset + fieldOffset) << "(%rbp)\n";
+                targetOut << " movq %rax, " << (structBaseOffset + static_cast<int>(desc->offset)) << "(%rbp)\n";
             }
         }
 
@@ -1051,8 +1044,7 @@ int GenCodeVisitor::visit(StructInitExp* exp) {
     return 0;
 }
 
-int GenCodeVisitor::visit(TypeAlias* ta) {
-    globalTypeAliases[ta->alias] = ta->type;
+int GenCodeVisitor::visit(TypeAlias*) {
     return 0;
 }
 
@@ -1063,7 +1055,6 @@ int GenCodeVisitor::visit(FloatExp* exp) {
     std::memcpy(&bits, &v, sizeof(bits));
     targetOut << " movabsq $" << bits << ", %rax\n";
     targetOut << " movq %rax, %xmm0\n";
-    lastType = exp->isDouble ? Type::F64 : Type::F32;
     return 0;
 }
 
@@ -1071,9 +1062,41 @@ int GenCodeVisitor::visit(FloatExp* exp) {
 // TypeCheckerVisitor - Implementaciones
 // =============================================================================
 
+ResolvedType TypeCheckerVisitor::resolveDeclared(const string& declared) {
+    ResolvedType rt;
+    rt.id = types.intern(declared);
+    const TypeDesc& desc = types.get(rt.id);
+    rt.scalar = desc.kind == TypeDesc::SCALAR ? desc.scalar : Type::NOTYPE;
+    rt.size = types.frameSize(rt.id);
+    return rt;
+}
+
+void TypeCheckerVisitor::reserveSlots(int slots) {
+    currentSlotCount += slots;
+    peakSlotCount = std::max(peakSlotCount, currentSlotCount);
+}
+
+// Como GenCodeVisitor::emitStatement: los temporales de la sentencia se
+// liberan al terminarla; un let conserva su variable
+void TypeCheckerVisitor::visitStatement(Stm* stm) {
+    int live = currentSlotCount;
+    stm->accept(this);
+    if (!as<LetStm>(stm)) currentSlotCount = live;
+}
+
+// Slots reservados para un struct literal (0 si el struct no existe)
+int TypeCheckerVisitor::slotsForStructInit(TypeId structType) const {
+    const TypeDesc& desc = types.get(structType);
+    return desc.kind == TypeDesc::STRUCT ? (static_cast<int>(desc.size) + 7) / 8 : 0;
+}
+
 int TypeCheckerVisitor::analyze(Program* program) {
     frameSlots.clear();
-    currentSlotCount = 0;
+    currentSlotCount = peakSlotCount = 0;
+    types.clear();
+    vars.clear();
+    returnTypes.clear();
+    constantValues.clear();
     program->accept(this);
     return 0;
 }
@@ -1082,12 +1105,23 @@ int TypeCheckerVisitor::visit(Program* program) {
     for (auto typeAlias : program->talist) {
         if (typeAlias) typeAlias->accept(this);
     }
+    // Las constantes antes que los structs: pueden dar el largo de un arreglo
+    ConstEvaluator consts(program, types);
+    consts.evaluateAll();
+    consts.fold(constantValues);
     for (auto structDecl : program->sdlist) {
         if (structDecl) structDecl->accept(this);
     }
+    types.layoutStructs();
     for (auto globalDecl : program->vdlist) {
         if (globalDecl) globalDecl->accept(this);
     }
+    // Tipos de retorno antes de los cuerpos: una llamada puede preceder a la definición
+    for (auto functionDecl : program->fdlist) {
+        if (functionDecl) {
+            returnTypes[global_interner().intern(functionDecl->nombre)] = resolveDeclared(functionDecl->tipo).scalar;
+        }
+    }
     for (auto functionDecl : program->fdlist) {
         if (functionDecl) functionDecl->accept(this);
     }
@@ -1095,10 +1129,20 @@ int TypeCheckerVisitor::visit(Program* program) {
 }
 
 int TypeCheckerVisitor::visit(FunDec* function) {
-    currentSlotCount = static_cast<int>(function->Nparametros.size());
+    currentSlotCount = peakSlotCount = 0;
+    reserveSlots(static_cast<int>(function->Nparametros.size()));
+    vars.clear();
+    vars.push_scope();
+    function->paramTypes.clear();
+    for (std::size_t idx = 0; idx < function->Nparametros.size(); ++idx) {
+        const string& declared = function->Tparametros[idx];
+        function->paramTypes.push_back(resolveDeclared(declared));
+        vars.declare(function->Nparametros[idx], VarType{function->paramTypes.back().scalar, function->paramTypes.back().id});
+    }
     if (function->cuerpo) function->cuerpo->accept(this);
-    frameSlots[function->nombre] = currentSlotCount;
-    currentSlotCount = 0;
+    frameSlots[function->nombre] = peakSlotCount;
+    currentSlotCount = peakSlotCount = 0;
+    vars.clear();
     return 0;
 }
 
@@ -1107,33 +1151,30 @@ int TypeCheckerVisitor::visit(Body* body) {
         if (decl) decl->accept(this);
     }
     for (auto stmt : body->stmlist) {
-        if (stmt) stmt->accept(this);
+        if (stmt) visitStatement(stmt);
     }
     return 0;
 }
 
 int TypeCheckerVisitor::visit(BlockStm* block) {
+    vars.push_scope();
+    int live = currentSlotCount;
     for (auto stmt : block->statements) {
-        if (stmt) stmt->accept(this);
+        if (stmt) visitStatement(stmt);
     }
+    currentSlotCount = live;
+    vars.pop_scope();
     return 0;
 }
 
 int TypeCheckerVisitor::visit(LetStm* letStmt) {
-    int slots = 1;
-    string typeName = resolve_alias(letStmt->type_name);
-    if (typeName.find("[") != string::npos) {
-        size_t open = typeName.find("[");
-        size_t close = typeName.find("]");
-        int count = stoi(typeName.substr(open + 1, close - open - 1));
-        int sizeBytes = count * 4;
-        slots = (sizeBytes + 7) / 8;
-    } else if (globalStructLayouts.count(typeName)) {
-        int sizeBytes = globalStructLayouts[typeName].size;
-        slots = (sizeBytes + 7) / 8;
-    }
-    currentSlotCount += slots;
+    letStmt->resolved = resolveDeclared(letStmt->type_name);
+    reserveSlots((letStmt->resolved.size + 7) / 8);
+    // Como en el generador, la variable ya es visible en su inicializador
+    vars.declare(letStmt->sym, VarType{letStmt->resolved.scalar, letStmt->resolved.id});
+    int live = currentSlotCount;
     if (letStmt->init) letStmt->init->accept(this);
+    currentSlotCount = live;
     return 0;
 }
 
@@ -1151,10 +1192,15 @@ int TypeCheckerVisitor::visit(WhileStm* whileStmt) {
 }
 
 int TypeCheckerVisitor::visit(ForStm* forStmt) {
-    ++currentSlotCount;
+    int live = currentSlotCount;
+    reserveSlots(1);
+    vars.push_scope();
+    vars.declare(forStmt->iterator, VarType{Type::I64, kNoType});
     if (forStmt->start) forStmt->start->accept(this);
     if (forStmt->end) forStmt->end->accept(this);
     if (forStmt->body) forStmt->body->accept(this);
+    currentSlotCount = live;
+    vars.pop_scope();
     return 0;
 }
 
@@ -1174,68 +1220,123 @@ int TypeCheckerVisitor::visit(ReturnStm* returnStmt) {
 }
 
 int TypeCheckerVisitor::visit(VarDec* varDec) {
-    currentSlotCount += static_cast<int>(varDec->variables.size());
+    reserveSlots(static_cast<int>(varDec->variables.size()));
+    // Dentro de una función son locales; las globales se leen como i64
+    if (!vars.empty()) {
+        for (const auto& name : varDec->variables) {
+            vars.declare(global_interner().intern(name), VarType{resolve_type(varDec->tipo), kNoType});
+        }
+    }
     return 0;
 }
 
+// Tipo del valor que cada expresión deja en %rax, con las mismas reglas que
+// aplica el generador al emitirla
 int TypeCheckerVisitor::visit(BinaryExp* exp) {
     if (exp->left) exp->left->accept(this);
     if (exp->right) exp->right->accept(this);
+
+    Type::TType left = exp->left ? exp->left->type : Type::NOTYPE;
+    Type::TType right = exp->right ? exp->right->type : Type::NOTYPE;
+    switch (exp->op) {
+        case ASSIGN_OP:
+            exp->type = right;
+            break;
+        case PLUS_OP: case MINUS_OP: case MUL_OP: case DIV_OP:
+            if (is_float(left) || is_float(right)) {
+                exp->type = (left == Type::F32 && right == Type::F32) ? Type::F32 : Type::F64;
+            } else {
+                exp->type = Type::I64;
+            }
+            break;
+        case POW_OP:
+            exp->type = Type::I64;
+            break;
+        default:
+            // Comparaciones y &&: 0/1 en %rax
+            exp->type = Type::BOOL;
+            break;
+    }
+    return 0;
+}
+
+int TypeCheckerVisitor::visit(NumberExp* exp) {
+    exp->type = Type::I64;
     return 0;
 }
 
-int TypeCheckerVisitor::visit(NumberExp*) { return 0; }
-int TypeCheckerVisitor::visit(BoolExp*) { return 0; }
-int TypeCheckerVisitor::visit(IdExp*) { return 0; }
-int TypeCheckerVisitor::visit(FloatExp*) { return 0; }
+int TypeCheckerVisitor::visit(BoolExp* exp) {
+    exp->type = Type::BOOL;
+    return 0;
+}
+
+int TypeCheckerVisitor::visit(IdExp* exp) {
+    // Sin declaración local es una global (quad de 8 bytes)
+    const VarType* var = vars.lookup(exp->sym);
+    exp->type = var ? var->scalar : Type::I64;
+    return 0;
+}
+
+int TypeCheckerVisitor::visit(FloatExp* exp) {
+    exp->type = exp->isDouble ? Type::F64 : Type::F32;
+    return 0;
+}
 
 int TypeCheckerVisitor::visit(FcallExp* exp) {
     for (auto arg : exp->argumentos) {
         if (arg) arg->accept(this);
     }
+    // Funciones externas (sin definición): el resultado queda en %rax como i64
+    auto it = returnTypes.find(exp->sym);
+    exp->type = it != returnTypes.end() ? it->second : Type::I64;
     return 0;
 }
 
 int TypeCheckerVisitor::visit(StructDec* sd) {
-    StructLayout layout;
-    int currentOffset = 0;
-    for (auto& field : sd->fields) {
-        layout.offsets[field.first] = currentOffset;
-        layout.types[field.first] = field.second;
-        string type = resolve_alias(field.second);
-        int size = 8;
-        if (type.find("[") != string::npos) {
-            size_t open = type.find("[");
-            size_t close = type.find("]");
-            int count = stoi(type.substr(open + 1, close - open - 1));
-            size = count * 4;
-        } else if (type == "i32" || type == "bool" || type == "u32" || type == "f32") {
-            size = 4;
-        }
-        layout.offsets[field.first] = currentOffset;
-        currentOffset += size;
-    }
-    layout.size = currentOffset;
-    globalStructLayouts[sd->name] = layout;
+    types.declareStruct(sd->name, sd->fields);
     return 0;
 }
 
 int TypeCheckerVisitor::visit(TypeAlias* ta) {
-    globalTypeAliases[ta->alias] = ta->type;
+    types.addAlias(ta->alias, ta->type);
     return 0;
 }
 
-int TypeCheckerVisitor::visit(ArrayAccessExp*) { return 0; }
-int TypeCheckerVisitor::visit(FieldAccessExp*) { return 0; }
-int TypeCheckerVisitor::visit(StructInitExp* exp) {
-    string resolvedName = resolve_alias(exp->name);
-    if (globalStructLayouts.count(resolvedName)) {
-        int size = globalStructLayouts[resolvedName].size;
-        int slots = (size + 7) / 8;
-        currentSlotCount += slots;
+// Los accesos no reservan slots; sólo se bajan a sus hijos para tiparlos
+int TypeCheckerVisitor::visit(ArrayAccessExp* exp) {
+    int slots = currentSlotCount;
+    if (exp->array) exp->array->accept(this);
+    if (exp->index) exp->index->accept(this);
+    currentSlotCount = slots;
+    exp->type = Type::I64;
+    if (IdExp* id = as<IdExp>(exp->array)) {
+        const VarType* var = vars.lookup(id->sym);
+        const TypeDesc& desc = types.get(var ? var->type : kNoType);
+        if (desc.kind == TypeDesc::ARRAY) exp->type = types.get(desc.element).scalar;
+    }
+    return 0;
+}
+
+int TypeCheckerVisitor::visit(FieldAccessExp* exp) {
+    int slots = currentSlotCount;
+    if (exp->object) exp->object->accept(this);
+    currentSlotCount = slots;
+    exp->type = Type::NOTYPE;
+    if (IdExp* id = as<IdExp>(exp->object)) {
+        const VarType* var = vars.lookup(id->sym);
+        if (const FieldDesc* field = var ? types.field(var->type, exp->field) : nullptr) {
+            exp->type = types.get(field->type).scalar;
+        }
     }
+    return 0;
+}
+
+int TypeCheckerVisitor::visit(StructInitExp* exp) {
+    exp->structType = types.intern(exp->name);
+    reserveSlots(slotsForStructInit(exp->structType));
     for (auto& field : exp->fields) {
         field.second->accept(this);
     }
+    exp->type = Type::NOTYPE;
     return 0;
-}
\ No newline at end of file
+}
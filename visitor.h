@@ -2,8 +2,9 @@
 #define VISITOR_H
 #include "ast.h"
 #include "environment.h"
+#include "type_table.h"
 #include "optimizer.h"
-#include <list>
+#include "line_table.h"
 #include <ostream>
 #include <string>
 #include <unordered_map>
@@ -13,7 +14,8 @@
 struct SymbolInfo {
     int offset = 0;
     Type::TType type = Type::NOTYPE;
-    std::string typeName;
+    int size = 8;         // bytes en el frame (ResolvedType::size)
+    TypeId typeId = kNoType;
     bool isMutable = false;
     bool initialized = false;
 };
@@ -22,7 +24,8 @@ struct SymbolInfo {
 struct DAGCacheEntry {
     int offset;           // Offset en stack donde está guardado el resultado
     Type::TType type;     // Tipo del resultado
-    std::string signature; // Firma de la expresión
+    Exp* exp;             // Expresión guardada (confirma el hash)
+    std::vector<SymbolId> reads; // Variables que lee (para invalidar)
 };
 
 class Visitor {
@@ -55,12 +58,28 @@ public:
     virtual int visit(FieldAccessExp* exp) = 0;
 };
 
+// Análisis semántico previo a la generación: calcula los slots de frame de
+// cada función y fija el tipo de cada expresión (Exp::type) y declaración
+// (LetStm::resolved, FunDec::paramTypes), para que el generador no vuelva
+// a derivarlos de los nombres de tipo en cada visita.
+//
+// Frame de cada función: los slots se reparten como una pila. Las variables
+// de un scope (bloque, for) se liberan al cerrarlo y los temporales de una
+// sentencia (struct literales) al terminarla, así que scopes hermanos y
+// loops consecutivos comparten espacio. frameSlots guarda el pico, que el
+// generador reproduce offset por offset con la misma disciplina.
 class TypeCheckerVisitor : public Visitor {
 public:
     std::unordered_map<std::string, int> frameSlots;
+    // Expresiones que sólo dependen de const items y const fn, con su valor
+    std::unordered_map<const Exp*, int64_t> constantValues;
 
     int analyze(Program* program);
 
+    // Tipos del último programa analizado
+    const TypeTable& typeTable() const { return types; }
+    void setFieldReordering(bool enable) { types.setFieldReordering(enable); }
+
     int visit(Program* program) override;
     int visit(FunDec* function) override;
     int visit(Body* body) override;
@@ -87,7 +106,22 @@ public:
     int visit(FieldAccessExp* exp) override;
 
 private:
-    int currentSlotCount = 0;
+    // Variable visible: tipo escalar y descriptor
+    struct VarType {
+        Type::TType scalar = Type::NOTYPE;
+        TypeId type = kNoType;
+    };
+
+    TypeTable types;
+    int currentSlotCount = 0;   // slots vivos en este punto de la función
+    int peakSlotCount = 0;      // máximo de currentSlotCount en la función
+    Environment<VarType, SymbolId> vars;
+    std::unordered_map<SymbolId, Type::TType> returnTypes;
+
+    ResolvedType resolveDeclared(const std::string& declared);
+    int slotsForStructInit(TypeId structType) const;
+    void reserveSlots(int slots);
+    void visitStatement(Stm* stm);
 };
 
 class GenCodeVisitor : public Visitor {
@@ -121,31 +155,44 @@ public:
     int visit(ArrayAccessExp* exp) override;
     int visit(FieldAccessExp* exp) override;
 
-    Type::TType lastType = Type::NOTYPE;
-    
     // Métodos para optimización
     void enableOptimizations(bool enable) { optimizationsEnabled = enable; }
     void enableDAGOptimization(bool enable) { dagEnabled = enable; optimizer.setDAGOptimization(enable); }
     void enablePeepholeOptimization(bool enable) { optimizer.setPeepholeOptimization(enable); }
     void printOptimizationStats(std::ostream& os);
 
+    // Layout de structs: reordenar campos para minimizar padding, y reporte
+    void setFieldReordering(bool enable) { typeChecker.setFieldReordering(enable); }
+    void printLayoutReport(std::ostream& os) const { typeChecker.typeTable().writeLayoutReport(os); }
+
+    // Anota cada sentencia con su línea de origen ("# linea N") para
+    // relacionar el assembly con el fuente al perfilar
+    void setSourceLines(const LineTable* table) { sourceLines = table; }
+
 private:
     std::ostream& out;
     TypeCheckerVisitor typeChecker;
     std::unordered_map<std::string, int> frameReservation;
-    Environment<SymbolInfo> symbols;
-    std::unordered_map<std::string, std::string> globalSymbols;
+    Environment<SymbolInfo, SymbolId> symbols;
+    std::unordered_map<SymbolId, std::string> globalSymbols;
 
-    int nextStackOffset = -8;
+    int nextStackOffset = -8;   // próximo slot libre (crece hacia abajo)
+    int frameBytes = 0;         // reservado en el prólogo de la función actual
     int nextLabelId = 0;
     bool insideFunction = false;
+    const LineTable* sourceLines = nullptr;
     std::string currentFunctionName;
     std::string currentReturnLabel;
 
     std::string makeLabel(const std::string& base);
-    SymbolInfo declareLocal(const std::string& name, const SymbolInfo& infoTemplate);
-    const SymbolInfo* lookupSymbol(const std::string& name) const;
-    SymbolInfo* lookupSymbol(const std::string& name);
+    bool constantValue(Exp* exp, int64_t& value) const;
+    int allocateFrame(int bytes);
+    void releaseFrame(int mark);
+    void emitStatement(Stm* stm);
+    SymbolInfo declareLocal(SymbolId name, const SymbolInfo& infoTemplate);
+    uint32_t elementSize(const SymbolInfo& info) const;
+    const SymbolInfo* lookupSymbol(SymbolId name) const;
+    SymbolInfo* lookupSymbol(SymbolId name);
     
     // Sistema de optimización Peephole
     bool optimizationsEnabled = true;
@@ -161,24 +208,21 @@ private:
     // ============================================
     bool dagEnabled = true;
     
-    // Cache de subexpresiones comunes: signature -> offset en stack
-    std::unordered_map<std::string, DAGCacheEntry> dagCache;
+    // Cache de subexpresiones comunes: hash estructural (Exp::hash) -> offset en stack
+    std::unordered_map<uint64_t, DAGCacheEntry> dagCache;
     
     // Contador de subexpresiones reutilizadas (para estadísticas)
     int dagHits = 0;
     int dagMisses = 0;
     
-    // Genera una firma única para una expresión
-    std::string generateExprSignature(Exp* exp);
-    
     // Busca una expresión en el cache DAG
-    DAGCacheEntry* lookupDAGCache(const std::string& signature);
+    DAGCacheEntry* lookupDAGCache(Exp* exp);
     
     // Guarda una expresión en el cache DAG
-    void saveToDAGCache(const std::string& signature, int offset, Type::TType type);
+    void saveToDAGCache(Exp* exp, int offset, Type::TType type);
     
     // Invalida entradas del cache que dependen de una variable
-    void invalidateDAGCache(const std::string& varName);
+    void invalidateDAGCache(SymbolId var);
     
     // Limpia todo el cache DAG
     void clearDAGCache();